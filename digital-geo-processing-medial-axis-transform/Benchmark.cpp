@@ -0,0 +1,229 @@
+#include "Benchmark.h"
+#include "MedialAxisTransformer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+/**
+ * Largest mean distance from the Voronoi pole centers of a synthetic shape to its exact medial axis,
+ * relative to the shape radius, accepted by runShape.
+ */
+static const double POLE_AXIS_TOLERANCE = 0.2;
+
+/**
+ * Runs every configuration on the mesh stored in an OFF file and prints the timing and quality table.
+ * All configurations solve the same set of samples, or a prefix of it.
+ * @param filename Path of the OFF file.
+ */
+void Benchmark::run(char* filename) {
+    Mesh* mesh = new Mesh();
+    mesh->loadOff(filename);
+
+    shape = nullptr;
+    runMesh(filename, mesh);
+}
+
+/**
+ * Runs every configuration on a synthetic shape and prints the timing and quality table.
+ * For shapes with an analytic medial axis the distance of the centers to the exact axis is reported as well.
+ * The run fails if the triangulation does not pass validateShape, or if the mean distance of the Voronoi pole
+ * centers to the exact axis exceeds POLE_AXIS_TOLERANCE times the shape radius.
+ * @param spec Shape parameters.
+ * @return True if every check passed.
+ */
+bool Benchmark::runShape(const ShapeSpec& spec) {
+    std::vector<float> coords;
+    std::vector<int> triangles;
+    generateShape(spec, coords, triangles);
+    if (!validateShape(spec, coords, triangles)) {
+        return false;
+    }
+    Mesh* mesh = new Mesh();
+    mesh->loadArrays(coords, triangles);
+
+    static const char* names[] = { "sphere", "torus", "capsule" };
+    std::string name = spec.noise != 0.0f ? std::string("noisy ") + names[static_cast<int>(spec.type)] : names[static_cast<int>(spec.type)];
+    shape = hasAnalyticMedialAxis(spec) ? &spec : nullptr;
+    runMesh(name.c_str(), mesh);
+    shape = nullptr;
+
+    if (hasAnalyticMedialAxis(spec) && rows[polesRow].meanAxisError > POLE_AXIS_TOLERANCE * spec.radius) {
+        std::fprintf(stderr, "Shape check failed: Voronoi pole centers are %g from the exact medial axis on average\n",
+            rows[polesRow].meanAxisError);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Runs every configuration on a mesh and prints the table.
+ * @param name Name of the mesh for the table header.
+ * @param mesh Pointer to the mesh.
+ */
+void Benchmark::runMesh(const char* name, Mesh* mesh) {
+    MedialAxisTransformer transformer(mesh);
+    std::vector<Vertex*> samples = transformer.samplePoints();
+
+    std::printf("%s: %d vertices, %d triangles, %d samples\n", name,
+        static_cast<int>(mesh->verts.size()), static_cast<int>(mesh->tris.size()), static_cast<int>(samples.size()));
+
+    MatEvaluator meshEvaluator(mesh);
+    evaluator = &meshEvaluator;
+    rows.clear();
+
+    std::vector<Vertex*> halfSamples(samples.begin(), samples.begin() + samples.size() / 2);
+    transformer.setSampling(SamplingMode::POISSON_DISK);
+    transformer.setNumSamples(static_cast<int>(halfSamples.size()));
+    std::vector<Vertex*> poissonSamples = transformer.samplePoints();
+    timeBisection(mesh, samples, false, 0.001f, 0.5f, "bisection, sample order");
+    timeBisection(mesh, samples, true, 0.001f, 0.5f, "bisection, Morton order");
+    timeBisection(mesh, samples, false, 0.01f, 0.5f, "bisection, tolerance 0.01");
+    timeBisection(mesh, samples, false, 0.001f, 1.0f, "bisection, full radius");
+    timeBisection(mesh, halfSamples, false, 0.001f, 0.5f, "bisection, half samples");
+    timeIncremental(mesh, halfSamples, 0.001f, samples, "bisection, add second half");
+    timeIncremental(mesh, samples, 0.01f, samples, "bisection, refine from 0.01");
+    timeBisection(mesh, poissonSamples, false, 0.001f, 0.5f, "bisection, half Poisson");
+    polesRow = rows.size();
+    timeVoronoiPoles(mesh, samples, "Voronoi poles");
+    timeVoronoiPoles(mesh, poissonSamples, "Voronoi poles, half Poisson");
+    timeDistanceTransform(mesh, 64, "distance transform, 64^3");
+    timeDistanceTransform(mesh, 128, "distance transform, 128^3");
+    printTable();
+    std::printf("Morton query order: %.2fx the speed of sample order\n", rows[0].seconds / rows[1].seconds);
+    evaluator = nullptr;
+}
+
+/**
+ * Times the bisection engine.
+ * @param mesh Pointer to the mesh to query.
+ * @param samples Vector of sampled points.
+ * @param morton True to process the queries in Morton order.
+ * @param tolerance Bisection stopping tolerance.
+ * @param radiusScale Factor applied to the bisected radius.
+ * @param name Configuration name for the table.
+ */
+void Benchmark::timeBisection(Mesh* mesh, const std::vector<Vertex*>& samples, bool morton, float tolerance, float radiusScale,
+    const char* name) {
+    MedialAxisTransformer transformer(mesh);
+    transformer.setMortonOrder(morton);
+    transformer.setTolerance(tolerance);
+    transformer.setRadiusScale(radiusScale);
+    std::vector<Vertex*> intersectionPoints = transformer.computeIntersectionPoints(samples);
+
+    std::vector<float> radii;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Vertex*> centers = transformer.computeMaximalBalls(intersectionPoints, radii);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    addRow(name, elapsed.count(), centers, radii);
+}
+
+/**
+ * Times the bisection engine on a transformer that already solved a first batch.
+ * Only the solve of the second batch is timed; samples and brackets from the first are reused.
+ * @param mesh Pointer to the mesh to query.
+ * @param warmSamples Samples solved first, untimed.
+ * @param warmTolerance Bisection tolerance of the first solve.
+ * @param samples Samples solved second at the default tolerance.
+ * @param name Configuration name for the table.
+ */
+void Benchmark::timeIncremental(Mesh* mesh, const std::vector<Vertex*>& warmSamples, float warmTolerance,
+    const std::vector<Vertex*>& samples, const char* name) {
+    MedialAxisTransformer transformer(mesh);
+    transformer.setTolerance(warmTolerance);
+    std::vector<float> radii;
+    transformer.computeMaximalBalls(transformer.computeIntersectionPoints(warmSamples), radii);
+
+    transformer.setTolerance(0.001f);
+    std::vector<Vertex*> intersectionPoints = transformer.computeIntersectionPoints(samples);
+    radii.clear();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Vertex*> centers = transformer.computeMaximalBalls(intersectionPoints, radii);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    addRow(name, elapsed.count(), centers, radii);
+}
+
+/**
+ * Times the Voronoi pole engine.
+ * @param mesh Pointer to the mesh the samples were drawn from.
+ * @param samples Vector of sampled points carrying outward normals.
+ * @param name Configuration name for the table.
+ */
+void Benchmark::timeVoronoiPoles(Mesh* mesh, const std::vector<Vertex*>& samples, const char* name) {
+    MedialAxisTransformer transformer(mesh);
+
+    std::vector<float> radii;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Vertex*> centers = transformer.computeVoronoiPoleBalls(samples, radii);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    addRow(name, elapsed.count(), centers, radii);
+}
+
+/**
+ * Times the distance transform engine, including the voxelization.
+ * @param mesh Pointer to the mesh.
+ * @param resolution Number of voxels along the longest side of the bounding box.
+ * @param name Configuration name for the table.
+ */
+void Benchmark::timeDistanceTransform(Mesh* mesh, int resolution, const char* name) {
+    MedialAxisTransformer transformer(mesh);
+    transformer.setVoxelResolution(resolution);
+
+    std::vector<float> radii;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<Vertex*> centers = transformer.computeDistanceTransformBalls(radii);
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    addRow(name, elapsed.count(), centers, radii);
+}
+
+/**
+ * Scores a set of balls and stores the row.
+ * @param name Configuration name for the table.
+ * @param seconds Time spent computing the balls.
+ * @param centers Vector of ball centers.
+ * @param radii Vector of ball radii.
+ */
+void Benchmark::addRow(const char* name, double seconds, const std::vector<Vertex*>& centers, const std::vector<float>& radii) {
+    // Balls of radius 0 only hold the place of samples without a ball
+    size_t numBalls = 0;
+    for (size_t i = 0; i < radii.size(); ++i) {
+        numBalls += radii[i] > 0.0f ? 1 : 0;
+    }
+    Row row = { name, seconds, numBalls, evaluator->evaluate(centers, radii), -1.0, -1.0 };
+    if (shape != nullptr) {
+        row.axisError = row.meanAxisError = 0.0;
+        for (size_t i = 0; i < centers.size(); ++i) {
+            if (!(radii[i] > 0.0f)) {
+                continue;
+            }
+            double error = distanceToMedialAxis(*shape, centers[i]->coords);
+            row.axisError = std::max(row.axisError, error);
+            row.meanAxisError += error / numBalls;
+        }
+    }
+    rows.push_back(row);
+}
+
+/**
+ * Prints the collected rows.
+ */
+void Benchmark::printTable() {
+    bool analytic = !rows.empty() && rows[0].axisError >= 0.0;
+    std::printf("%-28s %10s %8s %10s %10s %10s %10s %10s %10s", "configuration", "time (s)", "balls",
+        "H(B->M)", "H(M->B)", "Hausdorff", "mean B->M", "mean M->B", "eval (s)");
+    std::printf(analytic ? " %10s %10s\n" : "\n", "axis max", "axis mean");
+    for (size_t i = 0; i < rows.size(); ++i) {
+        const MatQuality& q = rows[i].quality;
+        std::printf("%-28s %10.4f %8d %10.5f %10.5f %10.5f %10.5f %10.5f %10.4f", rows[i].name, rows[i].seconds,
+            static_cast<int>(rows[i].balls), q.ballsToMesh, q.meshToBalls, q.hausdorff, q.meanBallsToMesh,
+            q.meanMeshToBalls, q.seconds);
+        if (analytic) {
+            std::printf(" %10.5f %10.5f", rows[i].axisError, rows[i].meanAxisError);
+        }
+        std::printf("\n");
+    }
+}
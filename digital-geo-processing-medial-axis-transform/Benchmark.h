@@ -0,0 +1,108 @@
+#pragma once
+
+#include "Mesh.h"
+#include "MatEvaluator.h"
+#include <vector>
+
+/**
+ * Class for timing the maximal ball engines on a mesh and printing the results as a table.
+ * Each configuration is also scored against the mesh surface, so speed can be traded against reconstruction error.
+ */
+class Benchmark {
+public:
+    /**
+     * Runs every configuration on the mesh stored in an OFF file and prints the timing and quality table.
+     * All configurations solve the same set of samples, or a prefix of it.
+     * @param filename Path of the OFF file.
+     */
+    void run(char* filename);
+
+    /**
+     * Runs every configuration on a synthetic shape and prints the timing and quality table.
+     * For shapes with an analytic medial axis the distance of the centers to the exact axis is reported as well.
+     * The run fails if the triangulation does not pass validateShape, or if the Voronoi pole centers
+     * are too far from the exact axis on average.
+     * @param spec Shape parameters.
+     * @return True if every check passed.
+     */
+    bool runShape(const ShapeSpec& spec);
+
+private:
+    /**
+     * A row of the result table.
+     */
+    struct Row {
+        const char* name; ///< Configuration name.
+        double seconds; ///< Wall-clock time of the maximal ball computation.
+        size_t balls; ///< Number of maximal balls produced.
+        MatQuality quality; ///< Reconstruction error of the balls.
+        double axisError; ///< Largest distance from a center to the exact medial axis, or -1 if unknown.
+        double meanAxisError; ///< Mean distance from a center to the exact medial axis, or -1 if unknown.
+    };
+
+    std::vector<Row> rows; ///< Results collected so far.
+    MatEvaluator* evaluator; ///< Scores the balls of the current mesh.
+    const ShapeSpec* shape; ///< Synthetic shape being measured, or nullptr for a mesh file.
+    size_t polesRow; ///< Row of the Voronoi pole engine on all samples.
+
+    /**
+     * Runs every configuration on a mesh and prints the table.
+     * @param name Name of the mesh for the table header.
+     * @param mesh Pointer to the mesh.
+     */
+    void runMesh(const char* name, Mesh* mesh);
+
+    /**
+     * Times the bisection engine.
+     * @param mesh Pointer to the mesh to query.
+     * @param samples Vector of sampled points.
+     * @param morton True to process the queries in Morton order.
+     * @param tolerance Bisection stopping tolerance.
+     * @param radiusScale Factor applied to the bisected radius.
+     * @param name Configuration name for the table.
+     */
+    void timeBisection(Mesh* mesh, const std::vector<Vertex*>& samples, bool morton, float tolerance, float radiusScale,
+        const char* name);
+
+    /**
+     * Times the bisection engine on a transformer that already solved a first batch.
+     * Only the solve of the second batch is timed; samples and brackets from the first are reused.
+     * @param mesh Pointer to the mesh to query.
+     * @param warmSamples Samples solved first, untimed.
+     * @param warmTolerance Bisection tolerance of the first solve.
+     * @param samples Samples solved second at the default tolerance.
+     * @param name Configuration name for the table.
+     */
+    void timeIncremental(Mesh* mesh, const std::vector<Vertex*>& warmSamples, float warmTolerance,
+        const std::vector<Vertex*>& samples, const char* name);
+
+    /**
+     * Times the Voronoi pole engine.
+     * @param mesh Pointer to the mesh the samples were drawn from.
+     * @param samples Vector of sampled points carrying outward normals.
+     * @param name Configuration name for the table.
+     */
+    void timeVoronoiPoles(Mesh* mesh, const std::vector<Vertex*>& samples, const char* name);
+
+    /**
+     * Times the distance transform engine, including the voxelization.
+     * @param mesh Pointer to the mesh.
+     * @param resolution Number of voxels along the longest side of the bounding box.
+     * @param name Configuration name for the table.
+     */
+    void timeDistanceTransform(Mesh* mesh, int resolution, const char* name);
+
+    /**
+     * Scores a set of balls and stores the row.
+     * @param name Configuration name for the table.
+     * @param seconds Time spent computing the balls.
+     * @param centers Vector of ball centers.
+     * @param radii Vector of ball radii.
+     */
+    void addRow(const char* name, double seconds, const std::vector<Vertex*>& centers, const std::vector<float>& radii);
+
+    /**
+     * Prints the collected rows.
+     */
+    void printTable();
+};
@@ -0,0 +1,396 @@
+#include "Bvh.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+/**
+ * Maximum number of triangles in a leaf.
+ */
+static const int LEAF_SIZE = 4;
+
+/**
+ * Orders triangle indices by their centroid along one axis.
+ */
+struct CentroidLess {
+    const std::vector<float>* centroids;
+    int axis;
+    bool operator()(int a, int b) const {
+        return (*centroids)[3 * a + axis] < (*centroids)[3 * b + axis];
+    }
+};
+
+/**
+ * Builds the hierarchy.
+ * Nodes are split at the median centroid along the longest axis of their centroid bounds.
+ * @param triangles Flat vector of triangle corners, 9 floats per triangle.
+ */
+void Bvh::build(const std::vector<float>& triangles) {
+    int numTris = static_cast<int>(triangles.size() / 9);
+    nodes.clear();
+    this->triangles.clear();
+    if (numTris == 0) {
+        return;
+    }
+
+    std::vector<float> centroids(3 * numTris);
+    std::vector<int> order(numTris);
+    for (int t = 0; t < numTris; ++t) {
+        for (int k = 0; k < 3; ++k) {
+            centroids[3 * t + k] = (triangles[9 * t + k] + triangles[9 * t + 3 + k] + triangles[9 * t + 6 + k]) / 3.0f;
+        }
+        order[t] = t;
+    }
+
+    struct Range {
+        int node, start, end;
+    };
+    std::vector<Range> stack;
+    nodes.push_back(Node());
+    Range root = { 0, 0, numTris };
+    stack.push_back(root);
+    while (!stack.empty()) {
+        Range range = stack.back();
+        stack.pop_back();
+
+        float bounds[6] = { triangles[9 * order[range.start]], triangles[9 * order[range.start] + 1], triangles[9 * order[range.start] + 2] };
+        bounds[3] = bounds[0];
+        bounds[4] = bounds[1];
+        bounds[5] = bounds[2];
+        float centroidMin[3] = { centroids[3 * order[range.start]], centroids[3 * order[range.start] + 1], centroids[3 * order[range.start] + 2] };
+        float centroidMax[3] = { centroidMin[0], centroidMin[1], centroidMin[2] };
+        for (int i = range.start; i < range.end; ++i) {
+            const float* tri = &triangles[9 * order[i]];
+            for (int k = 0; k < 3; ++k) {
+                for (int c = 0; c < 3; ++c) {
+                    bounds[k] = std::min(bounds[k], tri[3 * c + k]);
+                    bounds[3 + k] = std::max(bounds[3 + k], tri[3 * c + k]);
+                }
+                centroidMin[k] = std::min(centroidMin[k], centroids[3 * order[i] + k]);
+                centroidMax[k] = std::max(centroidMax[k], centroids[3 * order[i] + k]);
+            }
+        }
+        // Pad the box so that rounding in the slab test never loses a hit on a face lying in it
+        for (int k = 0; k < 3; ++k) {
+            float pad = 1e-5f * (bounds[3 + k] - bounds[k]) + 1e-7f;
+            bounds[k] -= pad;
+            bounds[3 + k] += pad;
+        }
+        std::copy(bounds, bounds + 6, nodes[range.node].bounds);
+
+        int count = range.end - range.start;
+        if (count <= LEAF_SIZE) {
+            nodes[range.node].first = range.start;
+            nodes[range.node].count = count;
+            continue;
+        }
+
+        int axis = 0;
+        for (int k = 1; k < 3; ++k) {
+            if (centroidMax[k] - centroidMin[k] > centroidMax[axis] - centroidMin[axis]) {
+                axis = k;
+            }
+        }
+        int mid = range.start + count / 2;
+        CentroidLess less = { &centroids, axis };
+        std::nth_element(order.begin() + range.start, order.begin() + mid, order.begin() + range.end, less);
+
+        int left = static_cast<int>(nodes.size());
+        nodes[range.node].first = left;
+        nodes[range.node].count = 0;
+        nodes.push_back(Node());
+        nodes.push_back(Node());
+        Range leftRange = { left, range.start, mid };
+        Range rightRange = { left + 1, mid, range.end };
+        stack.push_back(rightRange);
+        stack.push_back(leftRange);
+    }
+
+    this->triangles.resize(triangles.size());
+    for (int t = 0; t < numTris; ++t) {
+        std::copy(triangles.begin() + 9 * order[t], triangles.begin() + 9 * order[t] + 9, this->triangles.begin() + 9 * t);
+    }
+}
+
+/**
+ * Counts the triangles crossed by a ray.
+ * @param orig Origin point of the ray.
+ * @param dir Direction of the ray.
+ * @return The number of crossings.
+ */
+int Bvh::countCrossings(const float* orig, const float* dir) const {
+    if (nodes.empty()) {
+        return 0;
+    }
+    int crossings = 0;
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (!rayHitsBox(orig, dir, node.bounds)) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (int t = node.first; t < node.first + node.count; ++t) {
+                const float* tri = &triangles[9 * t];
+                if (rayHitsTriangle(orig, dir, tri, tri + 3, tri + 6)) {
+                    crossings++;
+                }
+            }
+        }
+        else {
+            stack[top++] = node.first;
+            stack[top++] = node.first + 1;
+        }
+    }
+    return crossings;
+}
+
+/**
+ * Computes the squared distance from a point to a box.
+ * @param point Coordinates of the point.
+ * @param bounds Min xyz followed by max xyz of the box.
+ * @return The squared distance; zero if the point is inside.
+ */
+static float pointBoxDistanceSquared(const float* point, const float* bounds) {
+    float d = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        float e = std::max(std::max(bounds[k] - point[k], point[k] - bounds[3 + k]), 0.0f);
+        d += e * e;
+    }
+    return d;
+}
+
+/**
+ * Computes the distance from a point to the closest triangle.
+ * Children are visited nearest first and skipped when their box is farther than the best triangle found.
+ * @param point Coordinates of the point.
+ * @return The distance, or a huge value if the hierarchy is empty.
+ */
+float Bvh::closestDistance(const float* point) const {
+    float best = FLT_MAX;
+    if (nodes.empty()) {
+        return best;
+    }
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (pointBoxDistanceSquared(point, node.bounds) >= best) {
+            continue;
+        }
+        if (node.count > 0) {
+            for (int t = node.first; t < node.first + node.count; ++t) {
+                const float* tri = &triangles[9 * t];
+                best = std::min(best, pointTriangleDistanceSquared(point, tri, tri + 3, tri + 6));
+            }
+        }
+        else {
+            float dLeft = pointBoxDistanceSquared(point, nodes[node.first].bounds);
+            float dRight = pointBoxDistanceSquared(point, nodes[node.first + 1].bounds);
+            // Push the farther child first so the nearer one is visited next
+            stack[top++] = dLeft < dRight ? node.first + 1 : node.first;
+            stack[top++] = dLeft < dRight ? node.first : node.first + 1;
+        }
+    }
+    return std::sqrt(best);
+}
+
+/**
+ * Returns the stored triangles in hierarchy order.
+ * @return Flat vector of triangle corners, 9 floats per triangle.
+ */
+const std::vector<float>& Bvh::getTriangles() const {
+    return triangles;
+}
+
+/**
+ * Returns the bounds of all triangles.
+ * @return Pointer to min xyz followed by max xyz, or nullptr if the hierarchy is empty.
+ */
+const float* Bvh::getBounds() const {
+    return nodes.empty() ? nullptr : nodes[0].bounds;
+}
+
+/**
+ * Returns the number of bytes held by the hierarchy.
+ * @return The memory usage in bytes.
+ */
+size_t Bvh::memoryUsage() const {
+    return nodes.size() * sizeof(Node) + triangles.size() * sizeof(float);
+}
+
+/**
+ * Writes the hierarchy to a binary file.
+ * @param file The open file.
+ * @return True on success.
+ */
+bool Bvh::write(FILE* file) const {
+    unsigned int counts[2] = { static_cast<unsigned int>(nodes.size()), static_cast<unsigned int>(triangles.size()) };
+    if (std::fwrite(counts, sizeof(unsigned int), 2, file) != 2) {
+        return false;
+    }
+    if (!nodes.empty() && std::fwrite(&nodes[0], sizeof(Node), nodes.size(), file) != nodes.size()) {
+        return false;
+    }
+    return triangles.empty() || std::fwrite(&triangles[0], sizeof(float), triangles.size(), file) == triangles.size();
+}
+
+/**
+ * Reads a hierarchy written by write.
+ * @param file The open file.
+ * @return True on success.
+ */
+bool Bvh::read(FILE* file) {
+    unsigned int counts[2];
+    if (std::fread(counts, sizeof(unsigned int), 2, file) != 2) {
+        return false;
+    }
+    nodes.resize(counts[0]);
+    triangles.resize(counts[1]);
+    if (!nodes.empty() && std::fread(&nodes[0], sizeof(Node), nodes.size(), file) != nodes.size()) {
+        return false;
+    }
+    return triangles.empty() || std::fread(&triangles[0], sizeof(float), triangles.size(), file) == triangles.size();
+}
+
+/**
+ * Performs ray-triangle intersection test (Moller-Trumbore).
+ * @param orig Origin point of the ray.
+ * @param dir Direction of the ray.
+ * @param v0 Vertex 0 of the triangle.
+ * @param v1 Vertex 1 of the triangle.
+ * @param v2 Vertex 2 of the triangle.
+ * @return True if the ray intersects the triangle, false otherwise.
+ */
+bool rayHitsTriangle(const float* orig, const float* dir, const float* v0, const float* v1, const float* v2) {
+    const float EPSILON = 0.0000001f;
+    float edge1[3], edge2[3], h[3], s[3], q[3];
+    float a, f, u, v;
+    for (int i = 0; i < 3; ++i) {
+        edge1[i] = v1[i] - v0[i];
+        edge2[i] = v2[i] - v0[i];
+    }
+    h[0] = dir[1] * edge2[2] - dir[2] * edge2[1];
+    h[1] = dir[2] * edge2[0] - dir[0] * edge2[2];
+    h[2] = dir[0] * edge2[1] - dir[1] * edge2[0];
+    a = edge1[0] * h[0] + edge1[1] * h[1] + edge1[2] * h[2];
+    if (a > -EPSILON && a < EPSILON) {
+        return false; // Ray is parallel to the triangle
+    }
+    f = 1.0f / a;
+    for (int i = 0; i < 3; ++i) {
+        s[i] = orig[i] - v0[i];
+    }
+    u = f * (s[0] * h[0] + s[1] * h[1] + s[2] * h[2]);
+    if (u < 0.0f || u > 1.0f) {
+        return false;
+    }
+    q[0] = s[1] * edge1[2] - s[2] * edge1[1];
+    q[1] = s[2] * edge1[0] - s[0] * edge1[2];
+    q[2] = s[0] * edge1[1] - s[1] * edge1[0];
+    v = f * (dir[0] * q[0] + dir[1] * q[1] + dir[2] * q[2]);
+    if (v < 0.0f || u + v > 1.0f) {
+        return false;
+    }
+    float t = f * (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]);
+    return t > EPSILON; // Intersection with the triangle
+}
+
+/**
+ * Computes the squared distance from a point to a triangle.
+ * Finds the closest point by classifying the point against the Voronoi regions of the triangle's vertices and edges.
+ * @param point Coordinates of the point.
+ * @param v0 Vertex 0 of the triangle.
+ * @param v1 Vertex 1 of the triangle.
+ * @param v2 Vertex 2 of the triangle.
+ * @return The squared distance.
+ */
+float pointTriangleDistanceSquared(const float* point, const float* v0, const float* v1, const float* v2) {
+    float ab[3], ac[3], ap[3], closest[3];
+    for (int k = 0; k < 3; ++k) {
+        ab[k] = v1[k] - v0[k];
+        ac[k] = v2[k] - v0[k];
+        ap[k] = point[k] - v0[k];
+    }
+    float d1 = ab[0] * ap[0] + ab[1] * ap[1] + ab[2] * ap[2];
+    float d2 = ac[0] * ap[0] + ac[1] * ap[1] + ac[2] * ap[2];
+    float bp[3], cp[3];
+    for (int k = 0; k < 3; ++k) {
+        bp[k] = point[k] - v1[k];
+        cp[k] = point[k] - v2[k];
+    }
+    float d3 = ab[0] * bp[0] + ab[1] * bp[1] + ab[2] * bp[2];
+    float d4 = ac[0] * bp[0] + ac[1] * bp[1] + ac[2] * bp[2];
+    float d5 = ab[0] * cp[0] + ab[1] * cp[1] + ab[2] * cp[2];
+    float d6 = ac[0] * cp[0] + ac[1] * cp[1] + ac[2] * cp[2];
+    float va = d3 * d6 - d5 * d4;
+    float vb = d5 * d2 - d1 * d6;
+    float vc = d1 * d4 - d3 * d2;
+
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+        std::copy(v0, v0 + 3, closest); // Vertex region of v0
+    }
+    else if (d3 >= 0.0f && d4 <= d3) {
+        std::copy(v1, v1 + 3, closest); // Vertex region of v1
+    }
+    else if (d6 >= 0.0f && d5 <= d6) {
+        std::copy(v2, v2 + 3, closest); // Vertex region of v2
+    }
+    else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+        float t = d1 / (d1 - d3); // Edge region of v0-v1
+        for (int k = 0; k < 3; ++k) closest[k] = v0[k] + t * ab[k];
+    }
+    else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+        float t = d2 / (d2 - d6); // Edge region of v0-v2
+        for (int k = 0; k < 3; ++k) closest[k] = v0[k] + t * ac[k];
+    }
+    else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+        float t = (d4 - d3) / ((d4 - d3) + (d5 - d6)); // Edge region of v1-v2
+        for (int k = 0; k < 3; ++k) closest[k] = v1[k] + t * (v2[k] - v1[k]);
+    }
+    else {
+        float denom = 1.0f / (va + vb + vc); // Face region
+        float v = vb * denom;
+        float w = vc * denom;
+        for (int k = 0; k < 3; ++k) closest[k] = v0[k] + v * ab[k] + w * ac[k];
+    }
+
+    float d = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        d += (point[k] - closest[k]) * (point[k] - closest[k]);
+    }
+    return d;
+}
+
+/**
+ * Performs ray-box intersection test (slab method).
+ * @param orig Origin point of the ray.
+ * @param dir Direction of the ray.
+ * @param bounds Min xyz followed by max xyz of the box.
+ * @return True if the ray intersects the box, false otherwise.
+ */
+bool rayHitsBox(const float* orig, const float* dir, const float* bounds) {
+    float tMin = 0.0f, tMax = 1e30f;
+    for (int k = 0; k < 3; ++k) {
+        if (dir[k] == 0.0f) {
+            if (orig[k] < bounds[k] || orig[k] > bounds[3 + k]) {
+                return false;
+            }
+            continue;
+        }
+        float inv = 1.0f / dir[k];
+        float t0 = (bounds[k] - orig[k]) * inv;
+        float t1 = (bounds[3 + k] - orig[k]) * inv;
+        if (t0 > t1) {
+            std::swap(t0, t1);
+        }
+        tMin = std::max(tMin, t0);
+        tMax = std::min(tMax, t1);
+        if (tMin > tMax) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <cstdio>
+#include <vector>
+
+/**
+ * Unit direction of the rays cast by the inside tests. It is off every axis and diagonal, so axis-aligned
+ * models do not put the ray through edges, and unlike a direction taken from the point it is defined everywhere.
+ */
+static const float CROSSING_DIRECTION[3] = { 0.4082483f, 0.5773503f, 0.7071068f };
+
+/**
+ * Bounding volume hierarchy over a triangle soup.
+ * Triangles are stored as 9 consecutive floats and reordered so that every leaf refers to a contiguous range.
+ */
+class Bvh {
+public:
+    /**
+     * A node of the hierarchy. Leaves have count > 0 and cover triangles [first, first + count);
+     * inner nodes have count == 0 and their children at first and first + 1.
+     */
+    struct Node {
+        float bounds[6]; ///< Min xyz followed by max xyz.
+        int first;
+        int count;
+    };
+
+    /**
+     * Builds the hierarchy.
+     * @param triangles Flat vector of triangle corners, 9 floats per triangle.
+     */
+    void build(const std::vector<float>& triangles);
+
+    /**
+     * Counts the triangles crossed by a ray.
+     * @param orig Origin point of the ray.
+     * @param dir Direction of the ray.
+     * @return The number of crossings.
+     */
+    int countCrossings(const float* orig, const float* dir) const;
+
+    /**
+     * Computes the distance from a point to the closest triangle.
+     * @param point Coordinates of the point.
+     * @return The distance, or a huge value if the hierarchy is empty.
+     */
+    float closestDistance(const float* point) const;
+
+    /**
+     * Returns the stored triangles in hierarchy order.
+     * @return Flat vector of triangle corners, 9 floats per triangle.
+     */
+    const std::vector<float>& getTriangles() const;
+
+    /**
+     * Returns the bounds of all triangles.
+     * @return Pointer to min xyz followed by max xyz, or nullptr if the hierarchy is empty.
+     */
+    const float* getBounds() const;
+
+    /**
+     * Returns the number of bytes held by the hierarchy.
+     * @return The memory usage in bytes.
+     */
+    size_t memoryUsage() const;
+
+    /**
+     * Writes the hierarchy to a binary file.
+     * @param file The open file.
+     * @return True on success.
+     */
+    bool write(FILE* file) const;
+
+    /**
+     * Reads a hierarchy written by write.
+     * @param file The open file.
+     * @return True on success.
+     */
+    bool read(FILE* file);
+
+private:
+    std::vector<Node> nodes; ///< Nodes; the root is nodes[0].
+    std::vector<float> triangles; ///< Triangle corners in leaf order.
+};
+
+/**
+ * Performs ray-triangle intersection test.
+ * @param orig Origin point of the ray.
+ * @param dir Direction of the ray.
+ * @param v0 Vertex 0 of the triangle.
+ * @param v1 Vertex 1 of the triangle.
+ * @param v2 Vertex 2 of the triangle.
+ * @return True if the ray intersects the triangle, false otherwise.
+ */
+bool rayHitsTriangle(const float* orig, const float* dir, const float* v0, const float* v1, const float* v2);
+
+/**
+ * Computes the squared distance from a point to a triangle.
+ * @param point Coordinates of the point.
+ * @param v0 Vertex 0 of the triangle.
+ * @param v1 Vertex 1 of the triangle.
+ * @param v2 Vertex 2 of the triangle.
+ * @return The squared distance.
+ */
+float pointTriangleDistanceSquared(const float* point, const float* v0, const float* v1, const float* v2);
+
+/**
+ * Performs ray-box intersection test.
+ * @param orig Origin point of the ray.
+ * @param dir Direction of the ray.
+ * @param bounds Min xyz followed by max xyz of the box.
+ * @return True if the ray intersects the box, false otherwise.
+ */
+bool rayHitsBox(const float* orig, const float* dir, const float* bounds);
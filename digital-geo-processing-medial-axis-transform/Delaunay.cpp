@@ -0,0 +1,399 @@
+#include "Delaunay.h"
+#include "Morton.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+/**
+ * Constructor for Delaunay.
+ * Sets up a bounding tetrahedron and inserts the points in Morton order so that
+ * consecutive insertions are close to each other and the location walks stay short.
+ * @param points Vector of points to triangulate.
+ */
+Delaunay::Delaunay(const std::vector<Vertex*>& points) : numPoints(static_cast<int>(points.size())), lastTet(0) {
+    double minC[3] = { 0.0, 0.0, 0.0 }, maxC[3] = { 0.0, 0.0, 0.0 };
+    coords.resize(3 * (points.size() + 4));
+    for (size_t i = 0; i < points.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            coords[3 * i + k] = points[i]->coords[k];
+            if (i == 0 || coords[3 * i + k] < minC[k]) minC[k] = coords[3 * i + k];
+            if (i == 0 || coords[3 * i + k] > maxC[k]) maxC[k] = coords[3 * i + k];
+        }
+    }
+
+    // Bounding tetrahedron far enough away not to disturb the hull of the input
+    double extent = std::max(maxC[0] - minC[0], std::max(maxC[1] - minC[1], maxC[2] - minC[2]));
+    if (extent <= 0.0) {
+        extent = 1.0;
+    }
+    const double M = 100.0 * extent;
+    const double offsets[4][3] = { { -1, -1, -1 }, { 5, -1, -1 }, { -1, 5, -1 }, { -1, -1, 5 } };
+    for (int s = 0; s < 4; ++s) {
+        for (int k = 0; k < 3; ++k) {
+            coords[3 * (numPoints + s) + k] = 0.5 * (minC[k] + maxC[k]) + M * offsets[s][k];
+        }
+    }
+    newTet(numPoints, numPoints + 1, numPoints + 2, numPoints + 3);
+    if (orient(numPoints, numPoints + 1, numPoints + 2, numPoints + 3) < 0) {
+        std::swap(tets[0].v[2], tets[0].v[3]);
+    }
+
+    std::vector<int> order = mortonOrder(points);
+    for (size_t i = 0; i < order.size(); ++i) {
+        insert(order[i]);
+    }
+}
+
+/**
+ * Returns all tetrahedra, including dead slots and ones touching the bounding tetrahedron.
+ * @return A vector of tetrahedra.
+ */
+const std::vector<Delaunay::Tetrahedron>& Delaunay::getTetrahedra() const {
+    return tets;
+}
+
+/**
+ * Checks if a tetrahedron is alive and uses input points only.
+ * @param tet The tetrahedron to check.
+ * @return True if the tetrahedron belongs to the Delaunay tetrahedralization of the input.
+ */
+bool Delaunay::isFinite(const Tetrahedron& tet) const {
+    return tet.alive && tet.v[0] < numPoints && tet.v[1] < numPoints && tet.v[2] < numPoints && tet.v[3] < numPoints;
+}
+
+/**
+ * Computes the circumsphere of a tetrahedron.
+ * @param tet The tetrahedron.
+ * @param center Array of 3 doubles to store the circumcenter.
+ * @return The circumradius.
+ */
+double Delaunay::circumsphere(const Tetrahedron& tet, double* center) const {
+    const double* a = &coords[3 * tet.v[0]];
+    double b[3], c[3], d[3];
+    for (int k = 0; k < 3; ++k) {
+        b[k] = coords[3 * tet.v[1] + k] - a[k];
+        c[k] = coords[3 * tet.v[2] + k] - a[k];
+        d[k] = coords[3 * tet.v[3] + k] - a[k];
+    }
+    double cd[3] = { c[1] * d[2] - c[2] * d[1], c[2] * d[0] - c[0] * d[2], c[0] * d[1] - c[1] * d[0] };
+    double db[3] = { d[1] * b[2] - d[2] * b[1], d[2] * b[0] - d[0] * b[2], d[0] * b[1] - d[1] * b[0] };
+    double bc[3] = { b[1] * c[2] - b[2] * c[1], b[2] * c[0] - b[0] * c[2], b[0] * c[1] - b[1] * c[0] };
+    double bb = b[0] * b[0] + b[1] * b[1] + b[2] * b[2];
+    double cc = c[0] * c[0] + c[1] * c[1] + c[2] * c[2];
+    double dd = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+    double denom = 2.0 * (b[0] * cd[0] + b[1] * cd[1] + b[2] * cd[2]);
+    double offset[3];
+    for (int k = 0; k < 3; ++k) {
+        offset[k] = (bb * cd[k] + cc * db[k] + dd * bc[k]) / denom;
+        center[k] = a[k] + offset[k];
+    }
+    return std::sqrt(offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2]);
+}
+
+/**
+ * Computes the orientation of point d relative to the plane through a, b and c.
+ * @return Positive if (a, b, c, d) is positively oriented, negative if negative, zero if coplanar.
+ */
+double Delaunay::orient(int a, int b, int c, int d) const {
+    const double* pa = &coords[3 * a];
+    double u[3], v[3], w[3];
+    for (int k = 0; k < 3; ++k) {
+        u[k] = coords[3 * b + k] - pa[k];
+        v[k] = coords[3 * c + k] - pa[k];
+        w[k] = coords[3 * d + k] - pa[k];
+    }
+    return u[0] * (v[1] * w[2] - v[2] * w[1])
+        - u[1] * (v[0] * w[2] - v[2] * w[0])
+        + u[2] * (v[0] * w[1] - v[1] * w[0]);
+}
+
+/**
+ * Checks the position of point e relative to the circumsphere of the positively oriented tetrahedron (a, b, c, d).
+ * @return Positive if e is inside, negative if outside, zero if cospherical.
+ */
+double Delaunay::inSphere(int a, int b, int c, int d, int e) const {
+    const int ids[4] = { a, b, c, d };
+    const double* pe = &coords[3 * e];
+    double m[4][4];
+    for (int r = 0; r < 4; ++r) {
+        for (int k = 0; k < 3; ++k) {
+            m[r][k] = coords[3 * ids[r] + k] - pe[k];
+        }
+        m[r][3] = m[r][0] * m[r][0] + m[r][1] * m[r][1] + m[r][2] * m[r][2];
+    }
+    // Cofactor expansion along the lifted column
+    double det = 0.0;
+    for (int r = 0; r < 4; ++r) {
+        int r0 = (r + 1) % 4, r1 = (r + 2) % 4, r2 = (r + 3) % 4;
+        double minor = m[r0][0] * (m[r1][1] * m[r2][2] - m[r1][2] * m[r2][1])
+            - m[r0][1] * (m[r1][0] * m[r2][2] - m[r1][2] * m[r2][0])
+            + m[r0][2] * (m[r1][0] * m[r2][1] - m[r1][1] * m[r2][0]);
+        det += (r % 2 == 0 ? 1.0 : -1.0) * m[r][3] * minor;
+    }
+    return det;
+}
+
+/**
+ * Allocates a tetrahedron, reusing a dead slot if one is available.
+ * @return Index of the new tetrahedron.
+ */
+int Delaunay::newTet(int a, int b, int c, int d) {
+    Tetrahedron tet;
+    tet.v[0] = a;
+    tet.v[1] = b;
+    tet.v[2] = c;
+    tet.v[3] = d;
+    tet.adj[0] = tet.adj[1] = tet.adj[2] = tet.adj[3] = -1;
+    tet.alive = true;
+    if (!freeTets.empty()) {
+        int idx = freeTets.back();
+        freeTets.pop_back();
+        tets[idx] = tet;
+        return idx;
+    }
+    tets.push_back(tet);
+    return static_cast<int>(tets.size()) - 1;
+}
+
+/**
+ * Finds a tetrahedron containing a point by walking from lastTet.
+ * Falls back to a linear scan if the walk does not terminate.
+ * @param p Index of the point.
+ * @return Index of the containing tetrahedron.
+ */
+int Delaunay::locate(int p) {
+    int t = tets[lastTet].alive ? lastTet : 0;
+    while (!tets[t].alive) {
+        ++t;
+    }
+    size_t maxSteps = 4 * tets.size() + 16;
+    for (size_t step = 0; step < maxSteps; ++step) {
+        const Tetrahedron& tet = tets[t];
+        int next = -1;
+        // Rotate the first face tested to avoid cycling on degenerate configurations
+        for (int f = 0; f < 4 && next < 0; ++f) {
+            int i = (f + static_cast<int>(step)) % 4;
+            int v[4] = { tet.v[0], tet.v[1], tet.v[2], tet.v[3] };
+            v[i] = p;
+            if (tet.adj[i] >= 0 && orient(v[0], v[1], v[2], v[3]) < 0) {
+                next = tet.adj[i];
+            }
+        }
+        if (next < 0) {
+            return t;
+        }
+        t = next;
+    }
+
+    for (size_t i = 0; i < tets.size(); ++i) {
+        const Tetrahedron& tet = tets[i];
+        if (!tet.alive) {
+            continue;
+        }
+        bool inside = true;
+        for (int f = 0; f < 4 && inside; ++f) {
+            int v[4] = { tet.v[0], tet.v[1], tet.v[2], tet.v[3] };
+            v[f] = p;
+            inside = orient(v[0], v[1], v[2], v[3]) >= 0;
+        }
+        if (inside) {
+            return static_cast<int>(i);
+        }
+    }
+    return t;
+}
+
+/**
+ * Inserts a point, replacing the tetrahedra whose circumspheres contain it.
+ * The cavity is grown from the containing tetrahedron and shrunk back until every
+ * boundary face is visible from the point, so that the new tetrahedra are never inverted.
+ * @param p Index of the point.
+ */
+void Delaunay::insert(int p) {
+    int start = locate(p);
+    for (int i = 0; i < 4; ++i) {
+        int q = tets[start].v[i];
+        if (coords[3 * q] == coords[3 * p] && coords[3 * q + 1] == coords[3 * p + 1] && coords[3 * q + 2] == coords[3 * p + 2]) {
+            return; // Duplicate point
+        }
+    }
+
+    // Grow the cavity
+    const int stamp = p + 1;
+    std::vector<int> cavity;
+    if (cavityMark.size() < tets.size()) {
+        cavityMark.resize(tets.size(), 0);
+    }
+    cavity.push_back(start);
+    cavityMark[start] = stamp;
+    for (size_t c = 0; c < cavity.size(); ++c) {
+        const Tetrahedron& tet = tets[cavity[c]];
+        for (int i = 0; i < 4; ++i) {
+            int n = tet.adj[i];
+            if (n >= 0 && cavityMark[n] != stamp) {
+                const Tetrahedron& nt = tets[n];
+                if (inSphere(nt.v[0], nt.v[1], nt.v[2], nt.v[3], p) > 0) {
+                    cavityMark[n] = stamp;
+                    cavity.push_back(n);
+                }
+            }
+        }
+    }
+
+    // Shrink it until it is star-shaped with respect to p, connected, and bounded by a surface on which every
+    // edge lies on exactly two faces; the new tetrahedra are paired across those edges below
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t c = 0; c < cavity.size(); ++c) {
+            int t = cavity[c];
+            if (t == start || cavityMark[t] != stamp) {
+                continue;
+            }
+            const Tetrahedron& tet = tets[t];
+            for (int i = 0; i < 4; ++i) {
+                if (tet.adj[i] >= 0 && cavityMark[tet.adj[i]] == stamp) {
+                    continue;
+                }
+                int v[4] = { tet.v[0], tet.v[1], tet.v[2], tet.v[3] };
+                v[i] = p;
+                if (orient(v[0], v[1], v[2], v[3]) <= 0) {
+                    cavityMark[t] = 0;
+                    changed = true;
+                    break;
+                }
+            }
+        }
+        if (changed) {
+            continue;
+        }
+
+        // Drop the parts cut off from the start; reached tetrahedra are marked with -stamp meanwhile
+        std::vector<int> reached(1, start);
+        cavityMark[start] = -stamp;
+        for (size_t c = 0; c < reached.size(); ++c) {
+            for (int i = 0; i < 4; ++i) {
+                int n = tets[reached[c]].adj[i];
+                if (n >= 0 && cavityMark[n] == stamp) {
+                    cavityMark[n] = -stamp;
+                    reached.push_back(n);
+                }
+            }
+        }
+        for (size_t c = 0; c < cavity.size(); ++c) {
+            int& mark = cavityMark[cavity[c]];
+            if (mark == stamp) {
+                mark = 0;
+                changed = true;
+            }
+            else if (mark == -stamp) {
+                mark = stamp;
+            }
+        }
+        if (changed) {
+            continue;
+        }
+
+        // Count the boundary faces on each edge; at a pinched edge, drop a tetrahedron other than the start that touches it
+        std::vector<std::pair<std::pair<int, int>, int> > edges;
+        for (size_t c = 0; c < cavity.size(); ++c) {
+            int t = cavity[c];
+            if (cavityMark[t] != stamp) {
+                continue;
+            }
+            for (int i = 0; i < 4; ++i) {
+                int n = tets[t].adj[i];
+                if (n >= 0 && cavityMark[n] == stamp) {
+                    continue;
+                }
+                for (int j = 0; j < 4; ++j) {
+                    for (int k = j + 1; k < 4; ++k) {
+                        if (j != i && k != i) {
+                            int a = std::min(tets[t].v[j], tets[t].v[k]);
+                            int b = std::max(tets[t].v[j], tets[t].v[k]);
+                            edges.push_back(std::make_pair(std::make_pair(a, b), t));
+                        }
+                    }
+                }
+            }
+        }
+        std::sort(edges.begin(), edges.end());
+        for (size_t e = 0; e < edges.size() && !changed; ) {
+            size_t end = e;
+            while (end < edges.size() && edges[end].first == edges[e].first) {
+                ++end;
+            }
+            if (end - e != 2) {
+                for (size_t f = e; f < end && !changed; ++f) {
+                    if (edges[f].second != start) {
+                        cavityMark[edges[f].second] = 0;
+                        changed = true;
+                    }
+                }
+            }
+            e = end;
+        }
+    }
+
+    // Fill it with tetrahedra connecting p to the boundary faces
+    struct OpenFace {
+        int a, b, tet, face;
+        bool operator<(const OpenFace& o) const { return a < o.a || (a == o.a && b < o.b); }
+    };
+    std::vector<OpenFace> openFaces;
+    for (size_t c = 0; c < cavity.size(); ++c) {
+        int t = cavity[c];
+        if (cavityMark[t] != stamp) {
+            continue;
+        }
+        for (int i = 0; i < 4; ++i) {
+            int n = tets[t].adj[i];
+            if (n >= 0 && cavityMark[n] == stamp) {
+                continue;
+            }
+            int nt = newTet(tets[t].v[0], tets[t].v[1], tets[t].v[2], tets[t].v[3]);
+            tets[nt].v[i] = p;
+            tets[nt].adj[i] = n;
+            if (n >= 0) {
+                for (int j = 0; j < 4; ++j) {
+                    if (tets[n].adj[j] == t) {
+                        tets[n].adj[j] = nt;
+                    }
+                }
+            }
+            // The other faces contain p and are shared with the new tetrahedron on the same edge
+            for (int j = 0; j < 4; ++j) {
+                if (j == i) {
+                    continue;
+                }
+                int a = -1, b = -1;
+                for (int k = 0; k < 4; ++k) {
+                    if (k != i && k != j) {
+                        (a < 0 ? a : b) = tets[nt].v[k];
+                    }
+                }
+                if (a > b) {
+                    std::swap(a, b);
+                }
+                OpenFace face = { a, b, nt, j };
+                openFaces.push_back(face);
+            }
+            lastTet = nt;
+        }
+    }
+
+    // Each internal face is seen from both sides; pair them up by their edge opposite p,
+    // which the boundary check above guarantees to be shared by exactly two of them
+    std::sort(openFaces.begin(), openFaces.end());
+    for (size_t o = 0; o + 1 < openFaces.size(); o += 2) {
+        tets[openFaces[o].tet].adj[openFaces[o].face] = openFaces[o + 1].tet;
+        tets[openFaces[o + 1].tet].adj[openFaces[o + 1].face] = openFaces[o].tet;
+    }
+
+    for (size_t c = 0; c < cavity.size(); ++c) {
+        if (cavityMark[cavity[c]] == stamp) {
+            tets[cavity[c]].alive = false;
+            freeTets.push_back(cavity[c]);
+        }
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+
+/**
+ * 3D Delaunay tetrahedralization of a point set (incremental Bowyer-Watson).
+ * Points are inserted in spatially coherent order and located by walking from
+ * the last created tetrahedron, which gives expected O(n log n) construction.
+ */
+class Delaunay {
+public:
+    /**
+     * A tetrahedron of the triangulation.
+     * Vertices are positively oriented; adj[i] is the neighbor across the face opposite v[i] (-1 if none).
+     */
+    struct Tetrahedron {
+        int v[4];
+        int adj[4];
+        bool alive;
+    };
+
+    /**
+     * Constructor for Delaunay. Builds the tetrahedralization of the given points.
+     * @param points Vector of points to triangulate; vertex ids refer to positions in this vector.
+     */
+    Delaunay(const std::vector<Vertex*>& points);
+
+    /**
+     * Returns all tetrahedra, including dead slots and ones touching the bounding tetrahedron.
+     * @return A vector of tetrahedra.
+     */
+    const std::vector<Tetrahedron>& getTetrahedra() const;
+
+    /**
+     * Checks if a tetrahedron is alive and uses input points only.
+     * @param tet The tetrahedron to check.
+     * @return True if the tetrahedron belongs to the Delaunay tetrahedralization of the input.
+     */
+    bool isFinite(const Tetrahedron& tet) const;
+
+    /**
+     * Computes the circumsphere of a tetrahedron.
+     * @param tet The tetrahedron.
+     * @param center Array of 3 doubles to store the circumcenter.
+     * @return The circumradius.
+     */
+    double circumsphere(const Tetrahedron& tet, double* center) const;
+
+private:
+    std::vector<double> coords; ///< Flat xyz coordinates; the last 4 points form the bounding tetrahedron.
+    std::vector<Tetrahedron> tets; ///< Tetrahedra; dead ones are recycled through freeTets.
+    std::vector<int> freeTets; ///< Indices of dead tetrahedra available for reuse.
+    std::vector<int> cavityMark; ///< Per-tetrahedron stamp of the last insertion whose cavity contained it.
+    int numPoints; ///< Number of input points.
+    int lastTet; ///< Starting tetrahedron for the next point location walk.
+
+    /**
+     * Computes the orientation of point d relative to the plane through a, b and c.
+     * @return Positive if (a, b, c, d) is positively oriented, negative if negative, zero if coplanar.
+     */
+    double orient(int a, int b, int c, int d) const;
+
+    /**
+     * Checks the position of point e relative to the circumsphere of the positively oriented tetrahedron (a, b, c, d).
+     * @return Positive if e is inside, negative if outside, zero if cospherical.
+     */
+    double inSphere(int a, int b, int c, int d, int e) const;
+
+    /**
+     * Finds a tetrahedron containing a point by walking from lastTet.
+     * @param p Index of the point.
+     * @return Index of the containing tetrahedron.
+     */
+    int locate(int p);
+
+    /**
+     * Inserts a point, replacing the tetrahedra whose circumspheres contain it.
+     * @param p Index of the point.
+     */
+    void insert(int p);
+
+    /**
+     * Allocates a tetrahedron, reusing a dead slot if one is available.
+     * @return Index of the new tetrahedron.
+     */
+    int newTet(int a, int b, int c, int d);
+};
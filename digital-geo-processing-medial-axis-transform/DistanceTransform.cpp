@@ -0,0 +1,325 @@
+#include "DistanceTransform.h"
+#include "Morton.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * Largest resolution accepted by the constructor. Voxels are indexed by int in the feature grid, and
+ * with the padding every axis has at most resolution + 3 voxels, so 1027^3 stays below 2^31.
+ */
+static const int MAX_RESOLUTION = 1024;
+
+/**
+ * Constructor for DistanceTransform.
+ * @param resolution Number of voxels along the longest side of the bounding box, clamped to [1, MAX_RESOLUTION].
+ */
+DistanceTransform::DistanceTransform(int resolution) : resolution(std::max(1, std::min(resolution, MAX_RESOLUTION))), voxelSize(1.0f) {
+    dims[0] = dims[1] = dims[2] = 0;
+    origin[0] = origin[1] = origin[2] = 0.0f;
+}
+
+/**
+ * Returns the edge length of a voxel.
+ * @return The voxel size.
+ */
+float DistanceTransform::getVoxelSize() const {
+    return voxelSize;
+}
+
+/**
+ * Returns the index of a voxel.
+ * @param x Voxel coordinate along x.
+ * @param y Voxel coordinate along y.
+ * @param z Voxel coordinate along z.
+ * @return The index into inside and squaredDistances.
+ */
+size_t DistanceTransform::voxelIndex(int x, int y, int z) const {
+    return (static_cast<size_t>(z) * dims[1] + y) * dims[0] + x;
+}
+
+/**
+ * Checks if a point lies inside a triangle in the xy plane, with a tie-breaking rule for points on an edge:
+ * of two triangles on either side of a shared edge, exactly one contains the points of the edge.
+ * @param a First corner.
+ * @param b Second corner.
+ * @param c Third corner.
+ * @param x Coordinate of the point along x.
+ * @param y Coordinate of the point along y.
+ * @return True if the point is covered by the triangle.
+ */
+static bool coversColumn(const float* a, const float* b, const float* c, double x, double y) {
+    double area = (static_cast<double>(b[0]) - a[0]) * (static_cast<double>(c[1]) - a[1])
+        - (static_cast<double>(b[1]) - a[1]) * (static_cast<double>(c[0]) - a[0]);
+    if (area == 0.0) {
+        return false;
+    }
+    // Walk the corners counterclockwise
+    const float* corners[3] = { a, area > 0.0 ? b : c, area > 0.0 ? c : b };
+    for (int e = 0; e < 3; ++e) {
+        const float* p = corners[e];
+        const float* q = corners[(e + 1) % 3];
+        double dx = static_cast<double>(q[0]) - p[0];
+        double dy = static_cast<double>(q[1]) - p[1];
+        double side = dx * (y - p[1]) - dy * (x - p[0]);
+        if (side < 0.0) {
+            return false;
+        }
+        // On the edge: keep the points of edges heading down, or heading left when horizontal
+        if (side == 0.0 && !(dy < 0.0 || (dy == 0.0 && dx < 0.0))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Fills the occupancy grid of a closed mesh. A voxel is inside if its center is inside the mesh.
+ * Every triangle records where it crosses the columns of voxel centers it covers in the xy plane;
+ * each column is then filled between consecutive crossings.
+ * @param mesh Pointer to the mesh.
+ */
+void DistanceTransform::voxelize(Mesh* mesh) {
+    float minCoords[3], maxCoords[3];
+    computeBounds(mesh->verts, minCoords, maxCoords);
+    float extent = std::max(maxCoords[0] - minCoords[0], std::max(maxCoords[1] - minCoords[1], maxCoords[2] - minCoords[2]));
+    voxelSize = extent > 0.0f ? extent / resolution : 1.0f;
+    for (int k = 0; k < 3; ++k) {
+        // One voxel of padding on each side keeps the border outside
+        dims[k] = static_cast<int>(std::ceil((maxCoords[k] - minCoords[k]) / voxelSize)) + 2;
+        origin[k] = minCoords[k] - voxelSize;
+    }
+
+    // Crossings of each column, sorted by column with a counting sort
+    size_t numColumns = static_cast<size_t>(dims[0]) * dims[1];
+    std::vector<std::pair<size_t, float> > crossings;
+    for (size_t t = 0; t < mesh->tris.size(); ++t) {
+        const float* a = mesh->verts[mesh->tris[t]->v1i]->coords;
+        const float* b = mesh->verts[mesh->tris[t]->v2i]->coords;
+        const float* c = mesh->verts[mesh->tris[t]->v3i]->coords;
+        int lo[2], hi[2];
+        for (int k = 0; k < 2; ++k) {
+            float low = std::min(a[k], std::min(b[k], c[k]));
+            float high = std::max(a[k], std::max(b[k], c[k]));
+            lo[k] = std::max(0, static_cast<int>(std::ceil((low - origin[k]) / voxelSize - 0.5f)));
+            hi[k] = std::min(dims[k] - 1, static_cast<int>(std::floor((high - origin[k]) / voxelSize - 0.5f)));
+        }
+        double normal[3] = {
+            (static_cast<double>(b[1]) - a[1]) * (static_cast<double>(c[2]) - a[2]) - (static_cast<double>(b[2]) - a[2]) * (static_cast<double>(c[1]) - a[1]),
+            (static_cast<double>(b[2]) - a[2]) * (static_cast<double>(c[0]) - a[0]) - (static_cast<double>(b[0]) - a[0]) * (static_cast<double>(c[2]) - a[2]),
+            (static_cast<double>(b[0]) - a[0]) * (static_cast<double>(c[1]) - a[1]) - (static_cast<double>(b[1]) - a[1]) * (static_cast<double>(c[0]) - a[0])
+        };
+        for (int y = lo[1]; y <= hi[1]; ++y) {
+            double cy = origin[1] + (y + 0.5) * voxelSize;
+            for (int x = lo[0]; x <= hi[0]; ++x) {
+                double cx = origin[0] + (x + 0.5) * voxelSize;
+                if (coversColumn(a, b, c, cx, cy)) {
+                    // Height of the triangle plane above the column
+                    double z = a[2] - (normal[0] * (cx - a[0]) + normal[1] * (cy - a[1])) / normal[2];
+                    crossings.push_back(std::make_pair(static_cast<size_t>(y) * dims[0] + x, static_cast<float>(z)));
+                }
+            }
+        }
+    }
+    std::vector<size_t> columnStart(numColumns + 1, 0);
+    for (size_t i = 0; i < crossings.size(); ++i) {
+        ++columnStart[crossings[i].first + 1];
+    }
+    for (size_t column = 0; column < numColumns; ++column) {
+        columnStart[column + 1] += columnStart[column];
+    }
+    std::vector<float> heights(crossings.size());
+    std::vector<size_t> next(columnStart.begin(), columnStart.end() - 1);
+    for (size_t i = 0; i < crossings.size(); ++i) {
+        heights[next[crossings[i].first]++] = crossings[i].second;
+    }
+    crossings.clear();
+
+    inside.assign(numColumns * dims[2], 0);
+    parallelFor(numColumns, [&](size_t column) {
+        float* begin = heights.data() + columnStart[column];
+        float* end = heights.data() + columnStart[column + 1];
+        std::sort(begin, end);
+        int x = static_cast<int>(column % dims[0]);
+        int y = static_cast<int>(column / dims[0]);
+        // Voxel centers between an entering and a leaving crossing are inside; an unpaired last crossing is dropped
+        for (float* h = begin; h + 1 < end; h += 2) {
+            int first = std::max(0, static_cast<int>(std::ceil((h[0] - origin[2]) / voxelSize - 0.5f)));
+            int last = std::min(dims[2] - 1, static_cast<int>(std::ceil((h[1] - origin[2]) / voxelSize - 0.5f)) - 1);
+            for (int z = first; z <= last; ++z) {
+                inside[voxelIndex(x, y, z)] = 1;
+            }
+        }
+    });
+}
+
+/**
+ * Computes the exact squared distance transform of a sampled function along one line
+ * as the lower envelope of the parabolas rooted at each sample (Felzenszwalb-Huttenlocher).
+ * The feature of each sample, the source voxel of its distance, is carried over from the root of its parabola.
+ * @param f Values of the function, replaced by the transform.
+ * @param features Feature of each sample, replaced by the feature of the nearest root.
+ * @param n Number of samples.
+ * @param roots Scratch array of n ints for the roots of the envelope parabolas.
+ * @param bounds Scratch array of n + 1 floats for the ranges of the envelope parabolas.
+ * @param output Scratch array of n floats.
+ * @param outputFeatures Scratch array of n ints.
+ */
+static void distanceTransform1d(float* f, int* features, int n, int* roots, float* bounds, float* output, int* outputFeatures) {
+    const float INF = 1e20f;
+    int k = 0;
+    roots[0] = 0;
+    bounds[0] = -INF;
+    bounds[1] = INF;
+    for (int q = 1; q < n; ++q) {
+        // Drop the parabolas hidden by the new one; the first bound is -INF, so the first parabola never is
+        float s = ((f[q] + static_cast<float>(q) * q) - (f[roots[k]] + static_cast<float>(roots[k]) * roots[k])) / (2.0f * (q - roots[k]));
+        while (s <= bounds[k]) {
+            --k;
+            s = ((f[q] + static_cast<float>(q) * q) - (f[roots[k]] + static_cast<float>(roots[k]) * roots[k])) / (2.0f * (q - roots[k]));
+        }
+        ++k;
+        roots[k] = q;
+        bounds[k] = s;
+        bounds[k + 1] = INF;
+    }
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (bounds[k + 1] < q) {
+            ++k;
+        }
+        float d = static_cast<float>(q - roots[k]);
+        output[q] = d * d + f[roots[k]];
+        outputFeatures[q] = features[roots[k]];
+    }
+    std::copy(output, output + n, f);
+    std::copy(outputFeatures, outputFeatures + n, features);
+}
+
+/**
+ * Computes the squared distance, in voxels, from every voxel center to the nearest outside voxel center,
+ * and which outside voxel that is.
+ * The transform is separable: it runs along x, then y, then z, and the lines of each pass are independent.
+ */
+void DistanceTransform::computeDistances() {
+    const float INF = 1e20f;
+    squaredDistances.resize(inside.size());
+    features.resize(inside.size());
+    for (size_t i = 0; i < inside.size(); ++i) {
+        squaredDistances[i] = inside[i] ? INF : 0.0f;
+        features[i] = inside[i] ? -1 : static_cast<int>(i);
+    }
+
+    // Lines are handed out in blocks so that the scratch arrays are allocated once per block
+    const size_t LINES_PER_BLOCK = 256;
+    for (int axis = 0; axis < 3; ++axis) {
+        int other[2] = { (axis + 1) % 3, (axis + 2) % 3 };
+        size_t stride = axis == 0 ? 1 : (axis == 1 ? dims[0] : static_cast<size_t>(dims[0]) * dims[1]);
+        int n = dims[axis];
+        size_t numLines = static_cast<size_t>(dims[other[0]]) * dims[other[1]];
+        parallelFor((numLines + LINES_PER_BLOCK - 1) / LINES_PER_BLOCK, [&](size_t block) {
+            std::vector<float> f(n), bounds(n + 1), output(n);
+            std::vector<int> lineFeatures(n), roots(n), outputFeatures(n);
+            size_t end = std::min(numLines, (block + 1) * LINES_PER_BLOCK);
+            for (size_t line = block * LINES_PER_BLOCK; line < end; ++line) {
+                int coords[3];
+                coords[axis] = 0;
+                coords[other[0]] = static_cast<int>(line % dims[other[0]]);
+                coords[other[1]] = static_cast<int>(line / dims[other[0]]);
+                size_t first = voxelIndex(coords[0], coords[1], coords[2]);
+
+                for (int i = 0; i < n; ++i) {
+                    f[i] = squaredDistances[first + i * stride];
+                    lineFeatures[i] = features[first + i * stride];
+                }
+                distanceTransform1d(f.data(), lineFeatures.data(), n, roots.data(), bounds.data(), output.data(), outputFeatures.data());
+                for (int i = 0; i < n; ++i) {
+                    squaredDistances[first + i * stride] = f[i];
+                    features[first + i * stride] = lineFeatures[i];
+                }
+            }
+        });
+    }
+}
+
+/**
+ * Extracts the centers and radii of the maximal balls from the inside voxels that pass two tests.
+ * Ridge: for one of its 26 inside neighbours, the nearest outside voxels of the voxel and of the neighbour are
+ * at least MIN_GAP voxels apart and seen from the voxel at more than 120 degrees, so the voxel lies between two
+ * separate parts of the boundary. The gap discards the staircase of the voxelized surface, at the price of
+ * the medial axis of parts thinner than a few voxels.
+ * Ball containment: the ball of the voxel is not contained in the ball of a neighbour, which happens when the
+ * distance of the neighbour exceeds that of the voxel by at least their separation; this thins the ridge.
+ * The radius is the distance to the boundary, half a voxel short of the nearest outside voxel center.
+ * @param centers Flat vector to fill with xyz ball centers.
+ * @param radii Vector to fill with ball radii.
+ */
+void DistanceTransform::extractMedialVoxels(std::vector<float>& centers, std::vector<float>& radii) const {
+    const float RIDGE_COSINE = -0.5f;
+    const float MIN_GAP = 5.0f;
+    // Slack of the containment test for the rounding of voxel distances
+    const float SLACK = 0.25f;
+    int sliceSize = dims[0] * dims[1];
+    std::vector<std::vector<float> > sliceCenters(dims[2]), sliceRadii(dims[2]);
+    parallelFor(static_cast<size_t>(dims[2]), [&](size_t slice) {
+        int z = static_cast<int>(slice);
+        for (int y = 0; y < dims[1]; ++y) {
+            for (int x = 0; x < dims[0]; ++x) {
+                size_t index = voxelIndex(x, y, z);
+                if (!inside[index]) {
+                    continue;
+                }
+                int feature = features[index];
+                float toFeature[3] = {
+                    static_cast<float>(feature % dims[0] - x),
+                    static_cast<float>(feature % sliceSize / dims[0] - y),
+                    static_cast<float>(feature / sliceSize - z)
+                };
+                float distance = std::sqrt(squaredDistances[index]);
+                bool ridge = false, contained = false;
+                for (int dz = -1; dz <= 1 && !contained; ++dz) {
+                    for (int dy = -1; dy <= 1 && !contained; ++dy) {
+                        for (int dx = -1; dx <= 1 && !contained; ++dx) {
+                            // Inside voxels never touch the padded border, so the neighbours exist
+                            size_t neighbour = voxelIndex(x + dx, y + dy, z + dz);
+                            float step = std::sqrt(static_cast<float>(dx * dx + dy * dy + dz * dz));
+                            if (step == 0.0f) {
+                                continue;
+                            }
+                            if (std::sqrt(squaredDistances[neighbour]) >= distance + step - SLACK) {
+                                contained = true;
+                            }
+                            if (!inside[neighbour]) {
+                                continue;
+                            }
+                            int other = features[neighbour];
+                            float toOther[3] = {
+                                static_cast<float>(other % dims[0] - x),
+                                static_cast<float>(other % sliceSize / dims[0] - y),
+                                static_cast<float>(other / sliceSize - z)
+                            };
+                            float dot = toFeature[0] * toOther[0] + toFeature[1] * toOther[1] + toFeature[2] * toOther[2];
+                            float lengths = distance * std::sqrt(toOther[0] * toOther[0] + toOther[1] * toOther[1] + toOther[2] * toOther[2]);
+                            float gap[3] = { toOther[0] - toFeature[0], toOther[1] - toFeature[1], toOther[2] - toFeature[2] };
+                            if (dot < RIDGE_COSINE * lengths && gap[0] * gap[0] + gap[1] * gap[1] + gap[2] * gap[2] >= MIN_GAP * MIN_GAP) {
+                                ridge = true;
+                            }
+                        }
+                    }
+                }
+                if (!ridge || contained) {
+                    continue;
+                }
+                sliceCenters[slice].push_back(origin[0] + (x + 0.5f) * voxelSize);
+                sliceCenters[slice].push_back(origin[1] + (y + 0.5f) * voxelSize);
+                sliceCenters[slice].push_back(origin[2] + (z + 0.5f) * voxelSize);
+                sliceRadii[slice].push_back((distance - 0.5f) * voxelSize);
+            }
+        }
+    });
+
+    for (int z = 0; z < dims[2]; ++z) {
+        centers.insert(centers.end(), sliceCenters[z].begin(), sliceCenters[z].end());
+        radii.insert(radii.end(), sliceRadii[z].begin(), sliceRadii[z].end());
+    }
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+
+/**
+ * Medial axis of a closed mesh on a voxel grid.
+ * The mesh is voxelized into a solid occupancy grid by scanning columns of voxels along z, the exact squared
+ * Euclidean distance from every inside voxel to the outside is computed one axis at a time
+ * (Felzenszwalb-Huttenlocher) together with the nearest outside voxel, and the voxels on the ridge of
+ * the distance field whose ball is not contained in the ball of a neighbour form the medial axis.
+ * Each step is linear in the voxel count, and only voxelization visits the triangles.
+ */
+class DistanceTransform {
+public:
+    /**
+     * Constructor for DistanceTransform.
+     * @param resolution Number of voxels along the longest side of the bounding box, clamped to [1, 1024]
+     * so that voxel indices fit in an int.
+     */
+    DistanceTransform(int resolution);
+
+    /**
+     * Fills the occupancy grid of a closed mesh. A voxel is inside if its center is inside the mesh.
+     * @param mesh Pointer to the mesh.
+     */
+    void voxelize(Mesh* mesh);
+
+    /**
+     * Computes the squared distance, in voxels, from every voxel center to the nearest outside voxel center,
+     * and which outside voxel that is.
+     */
+    void computeDistances();
+
+    /**
+     * Extracts the centers and radii of the maximal balls: the inside voxels on the ridge of the distance field,
+     * where the nearest boundary jumps between neighbours, whose ball is not contained in the ball of a neighbour.
+     * @param centers Flat vector to fill with xyz ball centers.
+     * @param radii Vector to fill with ball radii.
+     */
+    void extractMedialVoxels(std::vector<float>& centers, std::vector<float>& radii) const;
+
+    /**
+     * Returns the edge length of a voxel.
+     * @return The voxel size.
+     */
+    float getVoxelSize() const;
+
+private:
+    int resolution; ///< Voxels along the longest side of the bounding box.
+    int dims[3]; ///< Number of voxels along each axis, including one voxel of padding on each side.
+    float origin[3]; ///< Corner of the grid; voxel (i, j, k) is centered at origin + (i + 0.5, j + 0.5, k + 0.5) * voxelSize.
+    float voxelSize; ///< Edge length of a voxel.
+    std::vector<unsigned char> inside; ///< Occupancy of each voxel, x fastest.
+    std::vector<float> squaredDistances; ///< Squared distance in voxels to the nearest outside voxel center.
+    std::vector<int> features; ///< Index of the nearest outside voxel; the resolution limit keeps it within int.
+
+    /**
+     * Returns the index of a voxel.
+     * @param x Voxel coordinate along x.
+     * @param y Voxel coordinate along y.
+     * @param z Voxel coordinate along z.
+     * @return The index into inside and squaredDistances.
+     */
+    size_t voxelIndex(int x, int y, int z) const;
+};
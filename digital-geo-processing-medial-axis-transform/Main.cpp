@@ -3,9 +3,106 @@
 #include "Mesh.h"
 #include "Painter.h"
 #include "MedialAxisTransformer.h"
+#include "Benchmark.h"
+#include "PolygonMedialAxisSolver.h"
+#include "Polygon2D.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
 
-int main(int, char** argv)
+int main(int argc, char** argv)
 {
+    char defaultName[] = "0.off";
+    char* filename = defaultName;
+    bool poles = false, morton = false, poisson = false;
+    int voxels = 0;
+    MatWriter* writer = nullptr;
+    char* chunkDir = nullptr;
+    size_t budgetMB = 1024;
+    ShapeSpec shape = defaultShape(ShapeType::SPHERE, 0);
+    bool synthetic = false;
+    char* outlineName = nullptr;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc)
+            filename = argv[++i];
+        else if (std::strcmp(argv[i], "--poles") == 0)
+            poles = true;
+        else if (std::strcmp(argv[i], "--morton") == 0)
+            morton = true;
+        else if (std::strcmp(argv[i], "--poisson") == 0)
+            poisson = true;
+        else if (std::strcmp(argv[i], "--edt") == 0 && i + 1 < argc)
+            voxels = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--ply") == 0 && i + 1 < argc)
+            writer = new MatWriter(argv[++i], MatFormat::BINARY_PLY);
+        else if (std::strcmp(argv[i], "--raw") == 0 && i + 1 < argc)
+            writer = new MatWriter(argv[++i], MatFormat::RAW_COLUMNS);
+        else if (std::strcmp(argv[i], "--ooc") == 0 && i + 2 < argc)
+        {
+            chunkDir = argv[++i];
+            budgetMB = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--shape") == 0 && i + 2 < argc)
+        {
+            // sphere, torus or capsule, followed by the triangle count
+            const char* types[] = { "sphere", "torus", "capsule" };
+            for (int t = 0; t < 3; t++)
+                if (std::strcmp(argv[i + 1], types[t]) == 0)
+                    shape = defaultShape(static_cast<ShapeType>(t), std::strtoll(argv[i + 2], nullptr, 10));
+            synthetic = shape.numTris > 0;
+            i += 2;
+        }
+        else if (std::strcmp(argv[i], "--noise") == 0 && i + 1 < argc)
+            shape.noise = static_cast<float>(std::atof(argv[++i])); // relative amplitude, after --shape
+        else if (std::strcmp(argv[i], "--save-off") == 0 && i + 1 < argc && synthetic)
+        {
+            std::vector<float> coords;
+            std::vector<int> triangles;
+            generateShape(shape, coords, triangles);
+            if (!validateShape(shape, coords, triangles))
+                return 1;
+            if (!writeOff(argv[++i], coords, triangles))
+            {
+                std::cerr << "Failed to write " << argv[i] << std::endl;
+                return 1;
+            }
+            return 0;
+        }
+        else if (std::strcmp(argv[i], "--polygon") == 0 && i + 1 < argc)
+            outlineName = argv[++i];
+        else if (std::strcmp(argv[i], "--bench") == 0)
+        {
+            Benchmark benchmark;
+            if (synthetic)
+                return benchmark.runShape(shape) ? 0 : 1;
+            benchmark.run(filename);
+            return 0;
+        }
+    }
+
+    if (chunkDir != nullptr)
+    {
+        // Out-of-core run: no rendering, balls are only streamed to the writer
+        OutOfCoreMesh chunks(chunkDir, budgetMB << 20);
+        if (!chunks.open(filename) && !chunks.build(filename))
+        {
+            std::cerr << "Failed to partition " << filename << " into " << chunkDir << std::endl;
+            return 1;
+        }
+        if (poles)
+            std::cerr << "Voronoi poles are not supported out of core, using bisection" << std::endl;
+        MedialAxisTransformer transformer(nullptr);
+        transformer.setOutOfCoreMesh(&chunks);
+        transformer.setWriter(writer);
+        size_t numBalls = transformer.streamMaximalBalls();
+        std::cout << numBalls << " maximal balls computed" << std::endl;
+        if (writer != nullptr && !writer->close())
+            std::cerr << "Failed to export the maximal balls" << std::endl;
+        return 0;
+    }
+
     HWND window = SoWin::init(argv[0]);
 
     SoWinExaminerViewer* viewer = new SoWinExaminerViewer(window);
@@ -13,16 +110,69 @@ int main(int, char** argv)
     SoSeparator* root = new SoSeparator;
     root->ref();
 
-    // Load and draw the mesh
-    Mesh* mesh = new Mesh();
     Painter* painter = new Painter();
-    char filename[] = "0.off";
-    mesh->loadOff(filename);
-    root->addChild(painter->getShapeSep(mesh));
+    if (outlineName != nullptr)
+    {
+        // 2D run: the medial axis of a planar outline, drawn in the z = 0 plane
+        Polygon2D* outline = new Polygon2D();
+        if (!outline->loadPolygon(outlineName))
+        {
+            std::cerr << "Failed to load " << outlineName << std::endl;
+            return 1;
+        }
+        root->addChild(painter->getPolygonSep(outline));
+
+        PolygonMedialAxisSolver solver;
+        solver.build(outline->coords, outline->segments);
+        std::vector<float> samples, normals, centers, radii;
+        int numSamples = std::max(256, static_cast<int>(outline->segments.size() / 2));
+        solver.samplePoints(numSamples, static_cast<unsigned>(std::time(0)), samples, normals);
+        solver.computeMaximalBalls(samples, normals, centers, radii);
+        root->addChild(painter->getSampledPointsSep(samples));
+        root->addChild(painter->getMedialAxisLinesSep(centers));
+
+        for (size_t b = 0; writer != nullptr && b < radii.size(); b++)
+        {
+            float center[3] = { centers[2 * b], centers[2 * b + 1], 0.0f };
+            int ball = writer->writeBall(center, radii[b], static_cast<int>(b));
+            if (ball > 0)
+                writer->writeEdge(ball - 1, ball);
+        }
+    }
+    else
+    {
+        // Load and draw the mesh
+        Mesh* mesh = new Mesh();
+        if (synthetic)
+        {
+            std::vector<float> coords;
+            std::vector<int> triangles;
+            generateShape(shape, coords, triangles);
+            if (!validateShape(shape, coords, triangles))
+                return 1;
+            mesh->loadArrays(coords, triangles);
+        }
+        else
+            mesh->loadOff(filename);
+        root->addChild(painter->getShapeSep(mesh));
 
-    // Initialize the Medial Axis Transformer and apply transformations
-    MedialAxisTransformer transformer(mesh);
-    root->addChild(transformer.transform(painter));
+        // Initialize the Medial Axis Transformer and apply transformations
+        MedialAxisTransformer transformer(mesh);
+        if (poles)
+            transformer.setEngine(MatEngine::VORONOI_POLES);
+        transformer.setMortonOrder(morton);
+        if (poisson)
+            transformer.setSampling(SamplingMode::POISSON_DISK);
+        if (voxels > 0)
+        {
+            transformer.setEngine(MatEngine::DISTANCE_TRANSFORM);
+            transformer.setVoxelResolution(voxels);
+        }
+        transformer.setWriter(writer);
+        root->addChild(transformer.transform(painter));
+    }
+    if (writer != nullptr && !writer->close())
+        std::cerr << "Failed to export the maximal balls" << std::endl;
 
     viewer->setSize(SbVec2s(640, 480));
     viewer->setSceneGraph(root);
@@ -0,0 +1,373 @@
+#include "MatEvaluator.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+/**
+ * Uniform grid over a set of items, stored as one index array sorted by cell.
+ */
+struct UniformGrid {
+    float min[3]; ///< Lower corner of the grid.
+    float cellSize; ///< Edge length of a cell.
+    int dims[3]; ///< Number of cells along each axis.
+    std::vector<int> cellStart; ///< Items of cell c are items[cellStart[c], cellStart[c + 1]).
+    std::vector<int> items; ///< Item indices grouped by cell.
+
+    /**
+     * Sets up the cells over a box.
+     * @param bounds Min xyz followed by max xyz of the box.
+     * @param size Preferred cell size; grown so that no axis has more than maxDim cells.
+     * @param maxDim Maximum number of cells along an axis.
+     */
+    void setup(const float* bounds, float size, int maxDim) {
+        float extent = std::max(bounds[3] - bounds[0], std::max(bounds[4] - bounds[1], bounds[5] - bounds[2]));
+        cellSize = std::max(size, extent / maxDim);
+        if (cellSize <= 0.0f) {
+            cellSize = 1.0f;
+        }
+        for (int k = 0; k < 3; ++k) {
+            min[k] = bounds[k];
+            dims[k] = std::min(maxDim, std::max(1, static_cast<int>(std::ceil((bounds[k + 3] - bounds[k]) / cellSize))));
+        }
+        cellStart.assign(static_cast<size_t>(dims[0]) * dims[1] * dims[2] + 1, 0);
+    }
+
+    /**
+     * Returns the cell coordinate of a value along one axis, clamped to the grid.
+     * @param value Coordinate of the point.
+     * @param axis Axis index.
+     * @return The cell coordinate.
+     */
+    int cellOf(float value, int axis) const {
+        int c = static_cast<int>(std::floor((value - min[axis]) / cellSize));
+        return std::min(dims[axis] - 1, std::max(0, c));
+    }
+
+    /**
+     * Returns the linear index of a cell.
+     * @param x Cell coordinate along x.
+     * @param y Cell coordinate along y.
+     * @param z Cell coordinate along z.
+     * @return The index into cellStart.
+     */
+    size_t cellIndex(int x, int y, int z) const {
+        return (static_cast<size_t>(z) * dims[1] + y) * dims[0] + x;
+    }
+};
+
+/**
+ * Fills a grid with points, each stored in the cell containing it.
+ * @param grid Grid already set up.
+ * @param points Flat vector of points, 3 floats each.
+ */
+static void fillPointGrid(UniformGrid& grid, const std::vector<float>& points) {
+    size_t numPoints = points.size() / 3;
+    std::vector<size_t> cells(numPoints);
+    for (size_t i = 0; i < numPoints; ++i) {
+        const float* p = &points[3 * i];
+        cells[i] = grid.cellIndex(grid.cellOf(p[0], 0), grid.cellOf(p[1], 1), grid.cellOf(p[2], 2));
+        ++grid.cellStart[cells[i] + 1];
+    }
+    for (size_t c = 1; c < grid.cellStart.size(); ++c) {
+        grid.cellStart[c] += grid.cellStart[c - 1];
+    }
+    grid.items.resize(numPoints);
+    std::vector<int> fill(grid.cellStart.begin(), grid.cellStart.end() - 1);
+    for (size_t i = 0; i < numPoints; ++i) {
+        grid.items[fill[cells[i]]++] = static_cast<int>(i);
+    }
+}
+
+/**
+ * Fills a grid with balls, each stored in every cell its bounding box overlaps.
+ * @param grid Grid already set up.
+ * @param centers Vector of ball centers.
+ * @param radii Vector of ball radii.
+ */
+static void fillBallGrid(UniformGrid& grid, const std::vector<Vertex*>& centers, const std::vector<float>& radii) {
+    // Two passes over the same cell ranges: count, then place
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<int> fill;
+        if (pass == 1) {
+            for (size_t c = 1; c < grid.cellStart.size(); ++c) {
+                grid.cellStart[c] += grid.cellStart[c - 1];
+            }
+            grid.items.resize(grid.cellStart.back());
+            fill.assign(grid.cellStart.begin(), grid.cellStart.end() - 1);
+        }
+        for (size_t i = 0; i < centers.size(); ++i) {
+            const float* c = centers[i]->coords;
+            int lo[3], hi[3];
+            for (int k = 0; k < 3; ++k) {
+                lo[k] = grid.cellOf(c[k] - radii[i], k);
+                hi[k] = grid.cellOf(c[k] + radii[i], k);
+            }
+            for (int z = lo[2]; z <= hi[2]; ++z) {
+                for (int y = lo[1]; y <= hi[1]; ++y) {
+                    for (int x = lo[0]; x <= hi[0]; ++x) {
+                        size_t cell = grid.cellIndex(x, y, z);
+                        if (pass == 0) {
+                            ++grid.cellStart[cell + 1];
+                        } else {
+                            grid.items[fill[cell]++] = static_cast<int>(i);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Finds the distance from a point to the closest point stored in a grid.
+ * Cells are visited in rings of growing Chebyshev distance until no closer point can exist.
+ * @param grid Grid filled by fillPointGrid.
+ * @param points Flat vector of the stored points.
+ * @param query Coordinates of the query point.
+ * @return The distance, or a huge value if the grid is empty.
+ */
+static float nearestPointDistance(const UniformGrid& grid, const std::vector<float>& points, const float* query) {
+    int center[3] = { grid.cellOf(query[0], 0), grid.cellOf(query[1], 1), grid.cellOf(query[2], 2) };
+    int maxRing = std::max(grid.dims[0], std::max(grid.dims[1], grid.dims[2]));
+    float best = HUGE_VALF;
+
+    for (int ring = 0; ring <= maxRing; ++ring) {
+        // Every point in this ring or beyond is at least (ring - 1) cells away; best holds a squared distance
+        float reach = (ring - 1) * grid.cellSize;
+        if (reach > 0.0f && best <= reach * reach) {
+            break;
+        }
+        for (int z = center[2] - ring; z <= center[2] + ring; ++z) {
+            if (z < 0 || z >= grid.dims[2]) {
+                continue;
+            }
+            for (int y = center[1] - ring; y <= center[1] + ring; ++y) {
+                if (y < 0 || y >= grid.dims[1]) {
+                    continue;
+                }
+                bool shellRow = std::abs(z - center[2]) == ring || std::abs(y - center[1]) == ring;
+                int step = shellRow ? 1 : 2 * ring;
+                for (int x = center[0] - ring; x <= center[0] + ring; x += std::max(1, step)) {
+                    if (x < 0 || x >= grid.dims[0]) {
+                        continue;
+                    }
+                    size_t cell = grid.cellIndex(x, y, z);
+                    for (int j = grid.cellStart[cell]; j < grid.cellStart[cell + 1]; ++j) {
+                        const float* p = &points[3 * static_cast<size_t>(grid.items[j])];
+                        float dx = p[0] - query[0], dy = p[1] - query[1], dz = p[2] - query[2];
+                        best = std::min(best, dx * dx + dy * dy + dz * dz);
+                    }
+                }
+            }
+        }
+    }
+    return std::sqrt(best);
+}
+
+/**
+ * Constructor for MatEvaluator. Builds the mesh BVH and samples the mesh surface.
+ * @param mesh Pointer to the input mesh.
+ * @param spacing Target distance between samples, or 0 for the mean edge length of the mesh.
+ */
+MatEvaluator::MatEvaluator(Mesh* mesh, float spacing) : spacing(spacing) {
+    size_t numTris = mesh->tris.size();
+    std::vector<float> soup(9 * numTris);
+    std::vector<double> cdf(numTris);
+    double totalArea = 0.0, totalEdge = 0.0;
+    for (size_t i = 0; i < numTris; ++i) {
+        Triangle* t = mesh->tris[i];
+        const float* corners[3] = { mesh->verts[t->v1i]->coords, mesh->verts[t->v2i]->coords, mesh->verts[t->v3i]->coords };
+        for (int c = 0; c < 3; ++c) {
+            std::copy(corners[c], corners[c] + 3, &soup[9 * i + 3 * c]);
+        }
+
+        float e1[3], e2[3], cross[3];
+        for (int k = 0; k < 3; ++k) {
+            e1[k] = corners[1][k] - corners[0][k];
+            e2[k] = corners[2][k] - corners[0][k];
+        }
+        cross[0] = e1[1] * e2[2] - e1[2] * e2[1];
+        cross[1] = e1[2] * e2[0] - e1[0] * e2[2];
+        cross[2] = e1[0] * e2[1] - e1[1] * e2[0];
+        totalArea += 0.5 * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        cdf[i] = totalArea;
+        totalEdge += std::sqrt(e1[0] * e1[0] + e1[1] * e1[1] + e1[2] * e1[2]);
+    }
+    bvh.build(soup);
+
+    if (this->spacing <= 0.0f && numTris > 0) {
+        this->spacing = static_cast<float>(totalEdge / numTris);
+    }
+    if (numTris == 0 || totalArea <= 0.0) {
+        return;
+    }
+
+    // Area-uniform samples, at least as many as triangles so that small features are covered
+    size_t numSamples = static_cast<size_t>(totalArea / (static_cast<double>(this->spacing) * this->spacing));
+    numSamples = std::min(static_cast<size_t>(1) << 22, std::max(numSamples, 2 * numTris));
+    surfacePoints.resize(3 * numSamples);
+
+    std::mt19937 generator(12345);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (size_t s = 0; s < numSamples; ++s) {
+        size_t t = std::lower_bound(cdf.begin(), cdf.end(), uniform(generator) * totalArea) - cdf.begin();
+        t = std::min(t, numTris - 1);
+        double u = uniform(generator), v = uniform(generator);
+        if (u + v > 1.0) {
+            u = 1.0 - u;
+            v = 1.0 - v;
+        }
+        const float* tri = &soup[9 * t];
+        for (int k = 0; k < 3; ++k) {
+            surfacePoints[3 * s + k] = static_cast<float>(tri[k] + u * (tri[3 + k] - tri[k]) + v * (tri[6 + k] - tri[k]));
+        }
+    }
+}
+
+/**
+ * Measures the distances between the union of the balls and the mesh surface.
+ * @param centers Vector of vertices representing the centers of the maximal balls.
+ * @param radii Vector of radii of the maximal balls.
+ * @return The distances.
+ */
+MatQuality MatEvaluator::evaluate(const std::vector<Vertex*>& centers, const std::vector<float>& radii) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MatQuality quality = { 0.0, 0.0, 0.0, 0.0, 0.0, 0.0 };
+
+    std::vector<float> boundary = sampleUnionBoundary(centers, radii);
+    size_t numBoundary = boundary.size() / 3;
+    size_t numSurface = surfacePoints.size() / 3;
+
+    if (numBoundary == 0 || numSurface == 0) {
+        quality.ballsToMesh = quality.meshToBalls = quality.hausdorff = HUGE_VAL;
+        quality.meanBallsToMesh = quality.meanMeshToBalls = HUGE_VAL;
+    } else {
+        std::vector<float> toMesh(numBoundary);
+        parallelFor(numBoundary, [&](size_t i) {
+            toMesh[i] = bvh.closestDistance(&boundary[3 * i]);
+        });
+
+        UniformGrid grid;
+        float bounds[6] = { HUGE_VALF, HUGE_VALF, HUGE_VALF, -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+        for (size_t i = 0; i < numBoundary; ++i) {
+            for (int k = 0; k < 3; ++k) {
+                bounds[k] = std::min(bounds[k], boundary[3 * i + k]);
+                bounds[k + 3] = std::max(bounds[k + 3], boundary[3 * i + k]);
+            }
+        }
+        grid.setup(bounds, spacing, 128);
+        fillPointGrid(grid, boundary);
+
+        std::vector<float> toBalls(numSurface);
+        parallelFor(numSurface, [&](size_t i) {
+            toBalls[i] = nearestPointDistance(grid, boundary, &surfacePoints[3 * i]);
+        });
+
+        double sum = 0.0;
+        for (size_t i = 0; i < numBoundary; ++i) {
+            quality.ballsToMesh = std::max(quality.ballsToMesh, static_cast<double>(toMesh[i]));
+            sum += toMesh[i];
+        }
+        quality.meanBallsToMesh = sum / numBoundary;
+
+        sum = 0.0;
+        for (size_t i = 0; i < numSurface; ++i) {
+            quality.meshToBalls = std::max(quality.meshToBalls, static_cast<double>(toBalls[i]));
+            sum += toBalls[i];
+        }
+        quality.meanMeshToBalls = sum / numSurface;
+        quality.hausdorff = std::max(quality.ballsToMesh, quality.meshToBalls);
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    quality.seconds = elapsed.count();
+    return quality;
+}
+
+/**
+ * Samples the boundary of the union of the balls.
+ * Every sphere gets a number of points proportional to its area; points inside another ball are dropped.
+ * Balls of radius 0 stand for samples without a ball and are skipped.
+ * @param centers Vector of ball centers.
+ * @param radii Vector of ball radii.
+ * @return The boundary samples, 3 floats each.
+ */
+std::vector<float> MatEvaluator::sampleUnionBoundary(const std::vector<Vertex*>& centers, const std::vector<float>& radii) {
+    size_t numBalls = centers.size();
+    std::vector<float> boundary;
+    if (numBalls == 0 || spacing <= 0.0f) {
+        return boundary;
+    }
+
+    // Prefix sums of the per-ball counts, so that every ball writes its own slice
+    const float pi = 3.14159265f;
+    std::vector<size_t> offsets(numBalls + 1, 0);
+    float bounds[6] = { HUGE_VALF, HUGE_VALF, HUGE_VALF, -HUGE_VALF, -HUGE_VALF, -HUGE_VALF };
+    double meanRadius = 0.0;
+    size_t numNonEmpty = 0;
+    for (size_t i = 0; i < numBalls; ++i) {
+        float r = radii[i];
+        if (!(r > 0.0f)) {
+            offsets[i + 1] = offsets[i]; // Placeholder for a sample without a ball
+            continue;
+        }
+        int count = static_cast<int>(std::ceil(4.0f * pi * r * r / (spacing * spacing)));
+        offsets[i + 1] = offsets[i] + std::min(2000, std::max(16, count));
+        for (int k = 0; k < 3; ++k) {
+            bounds[k] = std::min(bounds[k], centers[i]->coords[k] - r);
+            bounds[k + 3] = std::max(bounds[k + 3], centers[i]->coords[k] + r);
+        }
+        meanRadius += r;
+        ++numNonEmpty;
+    }
+    if (numNonEmpty == 0) {
+        return boundary;
+    }
+    meanRadius /= numNonEmpty;
+
+    UniformGrid grid;
+    grid.setup(bounds, static_cast<float>(meanRadius), 64);
+    fillBallGrid(grid, centers, radii);
+
+    std::vector<float> points(3 * offsets[numBalls]);
+    std::vector<char> exposed(offsets[numBalls], 0);
+    parallelFor(numBalls, [&](size_t i) {
+        const float* c = centers[i]->coords;
+        float r = radii[i];
+        size_t count = offsets[i + 1] - offsets[i];
+        // Fibonacci lattice on the sphere
+        const float goldenAngle = pi * (3.0f - std::sqrt(5.0f));
+        for (size_t j = 0; j < count; ++j) {
+            float z = 1.0f - (2.0f * j + 1.0f) / count;
+            float ring = std::sqrt(std::max(0.0f, 1.0f - z * z));
+            float phi = goldenAngle * j;
+            float* p = &points[3 * (offsets[i] + j)];
+            p[0] = c[0] + r * ring * std::cos(phi);
+            p[1] = c[1] + r * ring * std::sin(phi);
+            p[2] = c[2] + r * z;
+
+            bool covered = false;
+            size_t cell = grid.cellIndex(grid.cellOf(p[0], 0), grid.cellOf(p[1], 1), grid.cellOf(p[2], 2));
+            for (int k = grid.cellStart[cell]; k < grid.cellStart[cell + 1] && !covered; ++k) {
+                size_t other = static_cast<size_t>(grid.items[k]);
+                if (other == i) {
+                    continue;
+                }
+                const float* o = centers[other]->coords;
+                float dx = p[0] - o[0], dy = p[1] - o[1], dz = p[2] - o[2];
+                float inner = radii[other] * (1.0f - 1e-4f);
+                covered = dx * dx + dy * dy + dz * dz < inner * inner;
+            }
+            exposed[offsets[i] + j] = !covered;
+        }
+    });
+
+    for (size_t j = 0; j < exposed.size(); ++j) {
+        if (exposed[j]) {
+            boundary.insert(boundary.end(), &points[3 * j], &points[3 * j] + 3);
+        }
+    }
+    return boundary;
+}
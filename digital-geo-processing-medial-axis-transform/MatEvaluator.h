@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Mesh.h"
+#include "Bvh.h"
+#include <vector>
+
+/**
+ * Distances between the boundary of the union of the maximal balls and the mesh surface.
+ */
+struct MatQuality {
+    double ballsToMesh; ///< One-sided Hausdorff distance from the union boundary to the mesh surface.
+    double meshToBalls; ///< One-sided Hausdorff distance from the mesh surface to the union boundary.
+    double hausdorff; ///< Two-sided Hausdorff distance.
+    double meanBallsToMesh; ///< Mean distance from the union boundary to the mesh surface.
+    double meanMeshToBalls; ///< Mean distance from the mesh surface to the union boundary.
+    double seconds; ///< Wall-clock time of the evaluation.
+};
+
+/**
+ * Class for measuring how well a set of maximal balls reconstructs the mesh.
+ * Both surfaces are sampled uniformly by area; distances to the mesh go through a BVH and
+ * distances to the union boundary through a uniform grid, with the work split over all hardware threads.
+ */
+class MatEvaluator {
+public:
+    /**
+     * Constructor for MatEvaluator. Builds the mesh BVH and samples the mesh surface.
+     * @param mesh Pointer to the input mesh.
+     * @param spacing Target distance between samples, or 0 for the mean edge length of the mesh.
+     */
+    MatEvaluator(Mesh* mesh, float spacing = 0.0f);
+
+    /**
+     * Measures the distances between the union of the balls and the mesh surface.
+     * @param centers Vector of vertices representing the centers of the maximal balls.
+     * @param radii Vector of radii of the maximal balls.
+     * @return The distances.
+     */
+    MatQuality evaluate(const std::vector<Vertex*>& centers, const std::vector<float>& radii);
+
+private:
+    Bvh bvh; ///< Hierarchy over the mesh triangles.
+    std::vector<float> surfacePoints; ///< Area-uniform samples of the mesh surface, 3 floats each.
+    float spacing; ///< Target distance between samples on both surfaces.
+
+    /**
+     * Samples the boundary of the union of the balls.
+     * Every sphere gets a number of points proportional to its area; points inside another ball are dropped.
+     * Balls of radius 0 stand for samples without a ball and are skipped.
+     * @param centers Vector of ball centers.
+     * @param radii Vector of ball radii.
+     * @return The boundary samples, 3 floats each.
+     */
+    std::vector<float> sampleUnionBoundary(const std::vector<Vertex*>& centers, const std::vector<float>& radii);
+};
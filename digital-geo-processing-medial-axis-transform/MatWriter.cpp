@@ -0,0 +1,205 @@
+#include "MatWriter.h"
+#include <cstring>
+
+/**
+ * Size of the write buffer of each stream in bytes.
+ */
+static const size_t BUFFER_SIZE = 1 << 20;
+
+/**
+ * Constructor for MatWriter. Opens the output files.
+ * @param path Output file for BINARY_PLY, or path prefix of the column files for RAW_COLUMNS.
+ * @param format The output format.
+ */
+MatWriter::MatWriter(const char* path, MatFormat format)
+    : format(format), path(path), numBalls(0), numEdges(0), vertexCountOffset(0), edgeCountOffset(0), failed(false), closed(false) {
+    balls.file = radii.file = samples.file = edges.file = nullptr;
+    if (format == MatFormat::BINARY_PLY) {
+        open(balls, this->path, "wb");
+        open(edges, edgeTempPath(), "w+b");
+        if (balls.file != nullptr) {
+            writePlyHeader();
+        }
+    }
+    else {
+        open(balls, this->path + ".centers.f32", "wb");
+        open(radii, this->path + ".radii.f32", "wb");
+        open(samples, this->path + ".samples.i32", "wb");
+        open(edges, this->path + ".edges.i32", "wb");
+    }
+}
+
+/**
+ * Destructor for MatWriter. Closes the output if close was not called.
+ */
+MatWriter::~MatWriter() {
+    close();
+}
+
+/**
+ * Checks if all output files could be opened.
+ * @return True if the writer is ready for writing.
+ */
+bool MatWriter::isOpen() const {
+    return !failed && !closed;
+}
+
+/**
+ * Appends a maximal ball.
+ * @param center Coordinates of the ball center.
+ * @param radius Radius of the ball.
+ * @param sample Index of the sample the ball was computed from.
+ * @return Index of the ball in the output, used to refer to it in writeEdge.
+ */
+int MatWriter::writeBall(const float* center, float radius, int sample) {
+    unsigned int bits[4];
+    std::memcpy(bits, center, 3 * sizeof(float));
+    std::memcpy(&bits[3], &radius, sizeof(float));
+    put(balls, bits[0]);
+    put(balls, bits[1]);
+    put(balls, bits[2]);
+    if (format == MatFormat::BINARY_PLY) {
+        put(balls, bits[3]);
+        put(balls, static_cast<unsigned int>(sample));
+    }
+    else {
+        put(radii, bits[3]);
+        put(samples, static_cast<unsigned int>(sample));
+    }
+    return numBalls++;
+}
+
+/**
+ * Appends a skeleton edge between two balls already written.
+ * @param from Index of the first ball.
+ * @param to Index of the second ball.
+ */
+void MatWriter::writeEdge(int from, int to) {
+    put(edges, static_cast<unsigned int>(from));
+    put(edges, static_cast<unsigned int>(to));
+    numEdges++;
+}
+
+/**
+ * Flushes all buffers, completes the file headers and closes the output.
+ * For PLY the buffered edge records are appended after the vertices and the
+ * element counts in the header are overwritten with the final values.
+ * @return True if everything was written successfully.
+ */
+bool MatWriter::close() {
+    if (closed) {
+        return !failed;
+    }
+    closed = true;
+
+    flush(balls);
+    flush(radii);
+    flush(samples);
+    flush(edges);
+
+    if (format == MatFormat::BINARY_PLY && balls.file != nullptr && edges.file != nullptr) {
+        // Append the edge element
+        std::rewind(edges.file);
+        std::vector<unsigned char> chunk(BUFFER_SIZE);
+        size_t n;
+        while ((n = std::fread(&chunk[0], 1, chunk.size(), edges.file)) > 0) {
+            if (std::fwrite(&chunk[0], 1, n, balls.file) != n) {
+                failed = true;
+            }
+        }
+
+        // Patch the element counts
+        char count[11];
+        std::snprintf(count, sizeof(count), "%010d", numBalls);
+        if (std::fseek(balls.file, vertexCountOffset, SEEK_SET) != 0 || std::fwrite(count, 1, 10, balls.file) != 10) {
+            failed = true;
+        }
+        std::snprintf(count, sizeof(count), "%010d", numEdges);
+        if (std::fseek(balls.file, edgeCountOffset, SEEK_SET) != 0 || std::fwrite(count, 1, 10, balls.file) != 10) {
+            failed = true;
+        }
+    }
+
+    Stream* streams[4] = { &balls, &radii, &samples, &edges };
+    for (int i = 0; i < 4; ++i) {
+        if (streams[i]->file != nullptr && std::fclose(streams[i]->file) != 0) {
+            failed = true;
+        }
+        streams[i]->file = nullptr;
+        std::vector<unsigned char>().swap(streams[i]->buffer);
+    }
+    if (format == MatFormat::BINARY_PLY) {
+        std::remove(edgeTempPath().c_str());
+    }
+    return !failed;
+}
+
+/**
+ * Opens a stream.
+ * @param stream The stream to open.
+ * @param name Path of the file.
+ * @param mode fopen mode.
+ */
+void MatWriter::open(Stream& stream, const std::string& name, const char* mode) {
+    stream.file = std::fopen(name.c_str(), mode);
+    stream.buffer.resize(BUFFER_SIZE);
+    stream.used = 0;
+    if (stream.file == nullptr) {
+        failed = true;
+    }
+}
+
+/**
+ * Appends a 32-bit value in little-endian byte order.
+ * @param stream The stream to write to.
+ * @param bits The value, as raw bits.
+ */
+void MatWriter::put(Stream& stream, unsigned int bits) {
+    if (stream.file == nullptr) {
+        return;
+    }
+    if (stream.used + 4 > stream.buffer.size()) {
+        flush(stream);
+    }
+    unsigned char* out = &stream.buffer[stream.used];
+    out[0] = static_cast<unsigned char>(bits);
+    out[1] = static_cast<unsigned char>(bits >> 8);
+    out[2] = static_cast<unsigned char>(bits >> 16);
+    out[3] = static_cast<unsigned char>(bits >> 24);
+    stream.used += 4;
+}
+
+/**
+ * Writes the buffered bytes of a stream to its file.
+ * @param stream The stream to flush.
+ */
+void MatWriter::flush(Stream& stream) {
+    if (stream.file == nullptr || stream.used == 0) {
+        return;
+    }
+    if (std::fwrite(&stream.buffer[0], 1, stream.used, stream.file) != stream.used) {
+        failed = true;
+    }
+    stream.used = 0;
+}
+
+/**
+ * Writes the PLY header with fixed-width element counts so it can be patched on close.
+ */
+void MatWriter::writePlyHeader() {
+    std::fputs("ply\nformat binary_little_endian 1.0\ncomment maximal balls of the medial axis transform\n", balls.file);
+    std::fputs("element vertex ", balls.file);
+    vertexCountOffset = std::ftell(balls.file);
+    std::fputs("0000000000\nproperty float x\nproperty float y\nproperty float z\nproperty float radius\nproperty int sample\n", balls.file);
+    std::fputs("element edge ", balls.file);
+    edgeCountOffset = std::ftell(balls.file);
+    std::fputs("0000000000\nproperty int vertex1\nproperty int vertex2\nend_header\n", balls.file);
+}
+
+/**
+ * Returns the edge file path used by the PLY format.
+ * @return Path of the temporary edge file.
+ */
+std::string MatWriter::edgeTempPath() const {
+    return path + ".edges.tmp";
+}
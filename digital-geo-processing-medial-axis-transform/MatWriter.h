@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * Output formats supported by MatWriter.
+ */
+enum class MatFormat {
+    BINARY_PLY,  ///< Single binary little-endian PLY file with a vertex element per ball and an edge element per skeleton edge.
+    RAW_COLUMNS  ///< One raw little-endian file per column: .centers.f32, .radii.f32, .samples.i32 and .edges.i32.
+};
+
+/**
+ * Class for streaming maximal balls and skeleton edges to disk while they are being computed.
+ * Records are packed into large buffers and written in blocks, so the result never has to be held in memory.
+ */
+class MatWriter {
+public:
+    /**
+     * Constructor for MatWriter. Opens the output files.
+     * @param path Output file for BINARY_PLY, or path prefix of the column files for RAW_COLUMNS.
+     * @param format The output format.
+     */
+    MatWriter(const char* path, MatFormat format);
+
+    /**
+     * Destructor for MatWriter. Closes the output if close was not called.
+     */
+    ~MatWriter();
+
+    /**
+     * Checks if all output files could be opened.
+     * @return True if the writer is ready for writing.
+     */
+    bool isOpen() const;
+
+    /**
+     * Appends a maximal ball.
+     * @param center Coordinates of the ball center.
+     * @param radius Radius of the ball.
+     * @param sample Index of the sample the ball was computed from.
+     * @return Index of the ball in the output, used to refer to it in writeEdge.
+     */
+    int writeBall(const float* center, float radius, int sample);
+
+    /**
+     * Appends a skeleton edge between two balls already written.
+     * @param from Index of the first ball.
+     * @param to Index of the second ball.
+     */
+    void writeEdge(int from, int to);
+
+    /**
+     * Flushes all buffers, completes the file headers and closes the output.
+     * @return True if everything was written successfully.
+     */
+    bool close();
+
+private:
+    /**
+     * A file with a large write buffer.
+     */
+    struct Stream {
+        FILE* file;
+        std::vector<unsigned char> buffer;
+        size_t used;
+    };
+
+    MatFormat format; ///< The output format.
+    std::string path; ///< Output path or prefix.
+    Stream balls; ///< Ball records (PLY) or centers (raw).
+    Stream radii; ///< Radii column (raw only).
+    Stream samples; ///< Sample index column (raw only).
+    Stream edges; ///< Edge records; a temporary file appended to the PLY on close.
+    int numBalls; ///< Number of balls written.
+    int numEdges; ///< Number of edges written.
+    long vertexCountOffset; ///< Position of the vertex count in the PLY header.
+    long edgeCountOffset; ///< Position of the edge count in the PLY header.
+    bool failed; ///< Set when any file operation fails.
+    bool closed; ///< Set once close has run.
+
+    /**
+     * Opens a stream.
+     * @param stream The stream to open.
+     * @param name Path of the file.
+     * @param mode fopen mode.
+     */
+    void open(Stream& stream, const std::string& name, const char* mode);
+
+    /**
+     * Appends a 32-bit value in little-endian byte order.
+     * @param stream The stream to write to.
+     * @param bits The value, as raw bits.
+     */
+    void put(Stream& stream, unsigned int bits);
+
+    /**
+     * Writes the buffered bytes of a stream to its file.
+     * @param stream The stream to flush.
+     */
+    void flush(Stream& stream);
+
+    /**
+     * Writes the PLY header with fixed-width element counts so it can be patched on close.
+     */
+    void writePlyHeader();
+
+    /**
+     * Returns the edge file path used by the PLY format.
+     * @return Path of the temporary edge file.
+     */
+    std::string edgeTempPath() const;
+};
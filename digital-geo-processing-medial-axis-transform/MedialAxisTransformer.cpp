@@ -1,4 +1,11 @@
 #include "MedialAxisTransformer.h"
+#include "Delaunay.h"
+#include "DistanceTransform.h"
+#include "Morton.h"
+#include "PoissonDisk.h"
+#include "SampleRandom.h"
+#include <algorithm>
+#include <cfloat>
 #include <cstdlib>
 #include <ctime>
 #include <cmath>
@@ -8,9 +15,158 @@
  * Initializes the mesh and sets the random seed.
  * @param mesh Pointer to the input mesh.
  */
-MedialAxisTransformer::MedialAxisTransformer(Mesh* mesh) : mesh(mesh) {
-    // Initialize random seed
-    std::srand(static_cast<unsigned>(std::time(0)));
+MedialAxisTransformer::MedialAxisTransformer(Mesh* mesh) : mesh(mesh), engine(MatEngine::BISECTION), useMortonOrder(false), writer(nullptr), outOfCore(nullptr), firstSample(0),
+    sampleCount(0), sampling(SamplingMode::RANDOM), sampleSpacing(0.0f), voxelResolution(128), tolerance(0.001f), radiusScale(0.5f), inwardOffset(0.05f), searchDistance(1.0f), prepared(false) {
+    // Time-based seed until setSeed is called
+    seed = static_cast<unsigned>(std::time(0));
+}
+
+/**
+ * Selects the algorithm used by transform to compute the maximal balls.
+ * @param engine The engine to use.
+ */
+void MedialAxisTransformer::setEngine(MatEngine engine) {
+    this->engine = engine;
+}
+
+/**
+ * Enables processing the queries of computeMaximalBalls in Morton order.
+ * Results are still returned in the order of the input points.
+ * @param enabled True to sort the queries by Morton code.
+ */
+void MedialAxisTransformer::setMortonOrder(bool enabled) {
+    useMortonOrder = enabled;
+}
+
+/**
+ * Sets the number of surface samples drawn by samplePoints.
+ * @param count Number of samples, or 0 for a quarter of the vertex count.
+ */
+void MedialAxisTransformer::setNumSamples(int count) {
+    sampleCount = count;
+}
+
+/**
+ * Selects how samplePoints places the samples.
+ * Poisson-disk samples cover the surface evenly, so fewer of them give the same coverage as random ones.
+ * @param mode The sampling mode.
+ */
+void MedialAxisTransformer::setSampling(SamplingMode mode) {
+    sampling = mode;
+}
+
+/**
+ * Sets the minimum distance between Poisson-disk samples.
+ * @param spacing The spacing, or 0 to derive it from the sample count.
+ */
+void MedialAxisTransformer::setSampleSpacing(float spacing) {
+    sampleSpacing = spacing;
+}
+
+/**
+ * Sets the grid used by the distance transform engine.
+ * @param resolution Number of voxels along the longest side of the bounding box; DistanceTransform clamps it to [1, 1024].
+ */
+void MedialAxisTransformer::setVoxelResolution(int resolution) {
+    voxelResolution = resolution;
+}
+
+/**
+ * Sets the seed from which every sample is drawn. Changing it discards the solved samples.
+ * @param seed The seed.
+ */
+void MedialAxisTransformer::setSeed(unsigned int seed) {
+    if (seed != this->seed) {
+        brackets.clear();
+    }
+    this->seed = seed;
+}
+
+/**
+ * Sets the convergence threshold of the binary search for the maximal ball centers.
+ * Solved samples are refined from their stored bracket when the tolerance is tightened
+ * and reused as they are when it is loosened. Zero, negative or denormal values act as the smallest
+ * interval the float coordinates can resolve.
+ * @param tolerance Length of the final search interval.
+ */
+void MedialAxisTransformer::setTolerance(float tolerance) {
+    this->tolerance = tolerance;
+}
+
+/**
+ * Sets how far the samples are moved inward to start the search. Changing it discards the solved samples.
+ * @param offset The inward offset.
+ */
+void MedialAxisTransformer::setInwardOffset(float offset) {
+    if (offset != inwardOffset) {
+        brackets.clear();
+    }
+    inwardOffset = offset;
+}
+
+/**
+ * Sets the length of the segment searched for the maximal ball center. Changing it discards the solved samples.
+ * @param distance The search distance.
+ */
+void MedialAxisTransformer::setSearchDistance(float distance) {
+    if (distance != searchDistance) {
+        brackets.clear();
+    }
+    searchDistance = distance;
+}
+
+/**
+ * Discards the state derived from the mesh and the solved samples. Call after modifying the mesh.
+ */
+void MedialAxisTransformer::invalidate() {
+    prepared = false;
+    areaSums.clear();
+    triangleNormals.clear();
+    bvh = Bvh();
+    brackets.clear();
+}
+
+/**
+ * Sets the factor applied to the search distance to obtain the radius of a bisection ball.
+ * @param scale The radius factor.
+ */
+void MedialAxisTransformer::setRadiusScale(float scale) {
+    radiusScale = scale;
+}
+
+/**
+ * Sets a writer that receives the maximal balls in input order, each as soon as it and every ball before it are computed.
+ * Consecutive balls are joined by a skeleton edge, like the medial axis lines drawn by Painter,
+ * except those of the distance transform engine, which come in voxel scan order.
+ * @param writer Pointer to the writer, or nullptr to disable streaming output.
+ */
+void MedialAxisTransformer::setWriter(MatWriter* writer) {
+    this->writer = writer;
+}
+
+/**
+ * Makes the inside test and the sampling use an out-of-core mesh instead of the in-memory one.
+ * @param outOfCore Pointer to the opened out-of-core mesh, or nullptr to use the in-memory mesh.
+ */
+void MedialAxisTransformer::setOutOfCoreMesh(OutOfCoreMesh* outOfCore) {
+    this->outOfCore = outOfCore;
+}
+
+/**
+ * Passes a computed ball to the writer, if any, together with the skeleton edge to the previous ball.
+ * @param center Coordinates of the ball center.
+ * @param radius Radius of the ball.
+ * @param sample Index of the sample the ball was computed from.
+ * @param linked False to write the ball without an edge, for balls whose order says nothing about adjacency.
+ */
+void MedialAxisTransformer::emitBall(const float* center, float radius, int sample, bool linked) {
+    if (writer == nullptr) {
+        return;
+    }
+    int ball = writer->writeBall(center, radius, firstSample + sample);
+    if (linked && ball > 0) {
+        writer->writeEdge(ball - 1, ball);
+    }
 }
 
 /**
@@ -31,135 +187,231 @@ float calculateTriangleArea(Vertex* v1, Vertex* v2, Vertex* v3) {
     return 0.5f * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
 }
 
+/**
+ * Calculates the unit normal of a triangle given its three vertices.
+ * The normal follows the winding order v1, v2, v3.
+ * @param v1 Pointer to the first vertex.
+ * @param v2 Pointer to the second vertex.
+ * @param v3 Pointer to the third vertex.
+ * @param normal Array of 3 floats to store the normal.
+ */
+void calculateTriangleNormal(Vertex* v1, Vertex* v2, Vertex* v3, float* normal) {
+    float a[3] = { v2->coords[0] - v1->coords[0], v2->coords[1] - v1->coords[1], v2->coords[2] - v1->coords[2] };
+    float b[3] = { v3->coords[0] - v1->coords[0], v3->coords[1] - v1->coords[1], v3->coords[2] - v1->coords[2] };
+    normal[0] = a[1] * b[2] - a[2] * b[1];
+    normal[1] = a[2] * b[0] - a[0] * b[2];
+    normal[2] = a[0] * b[1] - a[1] * b[0];
+    float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (length > 0.0f) {
+        normal[0] /= length;
+        normal[1] /= length;
+        normal[2] /= length;
+    }
+}
+
+/**
+ * Calculates the signed volume of the tetrahedron spanned by the origin and a triangle.
+ * Summed over a closed mesh this is positive when the triangles are wound counterclockwise seen from outside.
+ * @param v1 Pointer to the first vertex.
+ * @param v2 Pointer to the second vertex.
+ * @param v3 Pointer to the third vertex.
+ * @return The signed volume.
+ */
+float calculateSignedVolume(Vertex* v1, Vertex* v2, Vertex* v3) {
+    const float* a = v1->coords;
+    const float* b = v2->coords;
+    const float* c = v3->coords;
+    return (a[0] * (b[1] * c[2] - b[2] * c[1])
+        - a[1] * (b[0] * c[2] - b[2] * c[0])
+        + a[2] * (b[0] * c[1] - b[1] * c[0])) / 6.0f;
+}
+
 /**
  * Samples points on the surface of the mesh.
- * Points are sampled based on the area of each triangle in the mesh.
+ * Points are sampled based on the area of each triangle in the mesh, or of each chunk of the out-of-core mesh.
+ * Each sample carries the outward normal of the triangle it was drawn from.
+ * Sample i only depends on the seed and i, so asking for more samples keeps the earlier ones.
+ * Poisson-disk samples are a blue-noise subset of the random candidates; the out-of-core mesh is always sampled randomly.
  * @return A vector of sampled vertices.
  */
 std::vector<Vertex*> MedialAxisTransformer::samplePoints() {
     std::vector<Vertex*> sampledPoints;
-    // Calculate the total surface area of the mesh
-    float totalArea = 0.0f;
-    for (int i = 0; i < mesh->tris.size(); ++i) {
-        Triangle* tri = mesh->tris[i];
-        totalArea += calculateTriangleArea(mesh->verts[tri->v1i], mesh->verts[tri->v2i], mesh->verts[tri->v3i]);
+    if (outOfCore != nullptr) {
+        std::vector<int> quotas = computeChunkQuotas();
+        for (int c = 0; c < outOfCore->getNumChunks(); ++c) {
+            std::vector<Vertex*> chunkPoints = outOfCore->sampleChunk(c, quotas[c], static_cast<int>(sampledPoints.size()), seed);
+            sampledPoints.insert(sampledPoints.end(), chunkPoints.begin(), chunkPoints.end());
+        }
+        return sampledPoints;
+    }
+
+    prepareMesh();
+    if (areaSums.empty() || areaSums.back() <= 0.0) {
+        return sampledPoints;
     }
 
     // Number of points to sample
-    int numSamples = mesh->verts.size() / 4;
-
-
-    // Sample points based on triangle areas
-    for (int i = 0; i < numSamples; ++i) {
-        float r = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX) * totalArea;
-        float accumulatedArea = 0.0f;
-        Triangle* selectedTriangle = nullptr;
-        for (int j = 0; j < mesh->tris.size(); ++j) {
-            Triangle* tri = mesh->tris[j];
-            accumulatedArea += calculateTriangleArea(mesh->verts[tri->v1i], mesh->verts[tri->v2i], mesh->verts[tri->v3i]);
-            if (accumulatedArea >= r) {
-                selectedTriangle = tri;
-                break;
-            }
+    int numSamples = sampleCount > 0 ? sampleCount : static_cast<int>(mesh->verts.size()) / 4;
+
+    // Poisson-disk samples are a subset of the random candidates, so they keep their index
+    std::vector<int> samples;
+    if (sampling == SamplingMode::POISSON_DISK) {
+        samples = selectPoissonSamples(numSamples);
+    }
+    else {
+        for (int i = 0; i < numSamples; ++i) {
+            samples.push_back(i);
         }
+    }
+
+    for (size_t s = 0; s < samples.size(); ++s) {
+        int idx = mesh->verts.size() + samples[s];
+        float* coords = new float[3];
+        size_t t = drawSample(samples[s], coords);
+        Vertex* sampledVertex = new Vertex(idx, coords);
+        sampledVertex->normals = new float[3];
+        std::copy(&triangleNormals[3 * t], &triangleNormals[3 * t] + 3, sampledVertex->normals);
+        sampledPoints.push_back(sampledVertex);
+    }
+    return sampledPoints;
+}
+
+/**
+ * Draws candidate sample i: a point with density proportional to area, and the triangle it lies on.
+ * The point only depends on the seed and i.
+ * @param sample Index of the sample.
+ * @param coords Array of 3 floats to store the point.
+ * @return Index of the triangle.
+ */
+size_t MedialAxisTransformer::drawSample(int sample, float* coords) {
+    size_t t = std::upper_bound(areaSums.begin(), areaSums.end(), sampleRandom(seed, sample, 0) * areaSums.back()) - areaSums.begin();
+    t = std::min(t, areaSums.size() - 1);
+    Triangle* selectedTriangle = mesh->tris[t];
 
-        if (selectedTriangle != nullptr) {
-            // Barycentric coordinates to sample a point inside the selected triangle
-            float u = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
-            float v = static_cast<float>(std::rand()) / static_cast<float>(RAND_MAX);
-            if (u + v > 1.0f) {
-                u = 1.0f - u;
-                v = 1.0f - v;
+    // Barycentric coordinates to sample a point inside the selected triangle
+    float u = sampleRandom(seed, sample, 1);
+    float v = sampleRandom(seed, sample, 2);
+    if (u + v > 1.0f) {
+        u = 1.0f - u;
+        v = 1.0f - v;
+    }
+    float w = 1.0f - u - v;
+    const float* a = mesh->verts[selectedTriangle->v1i]->coords;
+    const float* b = mesh->verts[selectedTriangle->v2i]->coords;
+    const float* c = mesh->verts[selectedTriangle->v3i]->coords;
+    for (int k = 0; k < 3; ++k) {
+        coords[k] = u * a[k] + v * b[k] + w * c[k];
+    }
+    return t;
+}
+
+/**
+ * Selects Poisson-disk samples among the candidates drawn by drawSample.
+ * Without a spacing, the spacing is estimated from the area and the sample count and then bisected until
+ * at most 1% more samples than wanted are accepted; the surplus is thinned where the samples are densest.
+ * @param numSamples Number of samples wanted.
+ * @return Indices of the selected candidates in increasing order.
+ */
+std::vector<int> MedialAxisTransformer::selectPoissonSamples(int numSamples) {
+    // Dart throwing fills a surface with about 0.7 * area / spacing^2 points; a few candidates per point saturate it
+    const int CANDIDATES_PER_SAMPLE = 8;
+    const double FILL = 0.6;
+    // About 100 MB of coordinates and 300 MB while selecting; larger sets get fewer candidates per sample
+    const size_t MAX_CANDIDATES = static_cast<size_t>(1) << 23;
+    const double SLACK = 1.01;
+    const int MAX_ROUNDS = 16;
+    double totalArea = areaSums.back();
+    bool fixedSpacing = sampleSpacing > 0.0f;
+    float spacing = fixedSpacing ? sampleSpacing : static_cast<float>(std::sqrt(FILL * totalArea / std::max(1, numSamples)));
+    double expected = fixedSpacing ? FILL * totalArea / (static_cast<double>(spacing) * spacing) : numSamples;
+    size_t numCandidates = static_cast<size_t>(std::min(static_cast<double>(MAX_CANDIDATES), CANDIDATES_PER_SAMPLE * std::max(1.0, expected)));
+
+    std::vector<float> candidates(3 * numCandidates);
+    for (size_t i = 0; i < numCandidates; ++i) {
+        drawSample(static_cast<int>(i), &candidates[3 * i]);
+    }
+
+    std::vector<size_t> selected;
+    if (fixedSpacing) {
+        selected = selectPoissonDisk(candidates, spacing);
+    }
+    else {
+        // Largest spacing known to accept enough samples, and smallest known to accept too few
+        size_t target = static_cast<size_t>(std::max(1, numSamples));
+        float dense = 0.0f, sparse = 0.0f;
+        for (int round = 0; round < MAX_ROUNDS; ++round) {
+            std::vector<size_t> attempt = selectPoissonDisk(candidates, spacing);
+            float ratio = std::max(0.5f, std::sqrt(static_cast<float>(attempt.size()) / target));
+            if (attempt.size() >= target) {
+                dense = spacing;
+                selected.swap(attempt);
+                if (selected.size() <= SLACK * target) {
+                    break;
+                }
+            }
+            else {
+                sparse = spacing;
+                if (dense == 0.0f && attempt.size() > selected.size()) {
+                    selected.swap(attempt);
+                }
             }
-            float w = 1.0f - u - v;
-            float sampledPointCoords[3] = {
-                u * mesh->verts[selectedTriangle->v1i]->coords[0] +
-                v * mesh->verts[selectedTriangle->v2i]->coords[0] +
-                w * mesh->verts[selectedTriangle->v3i]->coords[0],
-
-                u * mesh->verts[selectedTriangle->v1i]->coords[1] +
-                v * mesh->verts[selectedTriangle->v2i]->coords[1] +
-                w * mesh->verts[selectedTriangle->v3i]->coords[1],
-
-                u * mesh->verts[selectedTriangle->v1i]->coords[2] +
-                v * mesh->verts[selectedTriangle->v2i]->coords[2] +
-                w * mesh->verts[selectedTriangle->v3i]->coords[2]
-            };
-
-            int idx = mesh->verts.size() + sampledPoints.size();
-            float* coords = new float[3];
-            coords[0] = sampledPointCoords[0];
-            coords[1] = sampledPointCoords[1];
-            coords[2] = sampledPointCoords[2];
-            Vertex* sampledVertex = new Vertex(idx, coords);
-            sampledPoints.push_back(sampledVertex);
+            spacing = dense > 0.0f && sparse > 0.0f ? 0.5f * (dense + sparse) : spacing * ratio * (dense > 0.0f ? 1.02f : 0.95f);
+        }
+        if (selected.size() > target) {
+            selected = thinPoissonDisk(candidates, selected, dense, target);
         }
     }
-    return sampledPoints;
+    return std::vector<int>(selected.begin(), selected.end());
 }
 
 /**
- * Checks if a point is inside the mesh using ray casting.
- * @param point Pointer to the point vertex.
- * @param mesh Pointer to the mesh.
- * @return True if the point is inside the mesh, false otherwise.
+ * Computes the area table, the outward normals and the BVH of the mesh unless they are up to date.
  */
-bool MedialAxisTransformer::isPointInsideMesh(Vertex* point, Mesh* mesh) {
-    int intersections = 0;
-    for (size_t i = 0; i < mesh->tris.size(); ++i) {
+void MedialAxisTransformer::prepareMesh() {
+    if (prepared || mesh == nullptr) {
+        return;
+    }
+    size_t numTris = mesh->tris.size();
+    areaSums.resize(numTris);
+    triangleNormals.resize(3 * numTris);
+    std::vector<float> soup(9 * numTris);
+    double totalArea = 0.0;
+    float signedVolume = 0.0f;
+    for (size_t i = 0; i < numTris; ++i) {
         Triangle* tri = mesh->tris[i];
-        Vertex* v1 = mesh->verts[tri->v1i];
-        Vertex* v2 = mesh->verts[tri->v2i];
-        Vertex* v3 = mesh->verts[tri->v3i];
+        Vertex* corners[3] = { mesh->verts[tri->v1i], mesh->verts[tri->v2i], mesh->verts[tri->v3i] };
+        totalArea += calculateTriangleArea(corners[0], corners[1], corners[2]);
+        areaSums[i] = totalArea;
+        signedVolume += calculateSignedVolume(corners[0], corners[1], corners[2]);
+        calculateTriangleNormal(corners[0], corners[1], corners[2], &triangleNormals[3 * i]);
+        for (int k = 0; k < 3; ++k) {
+            std::copy(corners[k]->coords, corners[k]->coords + 3, &soup[9 * i + 3 * k]);
+        }
+    }
 
-        // Ray casting along the x-axis
-        if (rayIntersectsTriangle(point->coords, v1->coords, v2->coords, v3->coords)) {
-            intersections++;
+    // Triangle normals point inward if the mesh is wound clockwise
+    if (signedVolume < 0.0f) {
+        for (size_t i = 0; i < triangleNormals.size(); ++i) {
+            triangleNormals[i] = -triangleNormals[i];
         }
     }
-    return (intersections % 2) == 1; // Point is inside if intersections count is odd
+    bvh.build(soup);
+    prepared = true;
 }
 
 /**
- * Performs ray-triangle intersection test.
- * @param orig Origin point of the ray.
- * @param v0 Vertex 0 of the triangle.
- * @param v1 Vertex 1 of the triangle.
- * @param v2 Vertex 2 of the triangle.
- * @return True if the ray intersects the triangle, false otherwise.
- */
-bool MedialAxisTransformer::rayIntersectsTriangle(const float* orig, const float* v0, const float* v1, const float* v2) {
-    const float EPSILON = 0.0000001f;
-    float edge1[3], edge2[3], h[3], s[3], q[3];
-    float a, f, u, v;
-    for (int i = 0; i < 3; ++i) {
-        edge1[i] = v1[i] - v0[i];
-        edge2[i] = v2[i] - v0[i];
-    }
-    h[0] = orig[1] * edge2[2] - orig[2] * edge2[1];
-    h[1] = orig[2] * edge2[0] - orig[0] * edge2[2];
-    h[2] = orig[0] * edge2[1] - orig[1] * edge2[0];
-    a = edge1[0] * h[0] + edge1[1] * h[1] + edge1[2] * h[2];
-    if (a > -EPSILON && a < EPSILON) {
-        return false; // Ray is parallel to the triangle
-    }
-    f = 1.0f / a;
-    for (int i = 0; i < 3; ++i) {
-        s[i] = orig[i] - v0[i];
-    }
-    u = f * (s[0] * h[0] + s[1] * h[1] + s[2] * h[2]);
-    if (u < 0.0f || u > 1.0f) {
-        return false;
-    }
-    q[0] = s[1] * edge1[2] - s[2] * edge1[1];
-    q[1] = s[2] * edge1[0] - s[0] * edge1[2];
-    q[2] = s[0] * edge1[1] - s[1] * edge1[0];
-    v = f * (orig[0] * q[0] + orig[1] * q[1] + orig[2] * q[2]);
-    if (v < 0.0f || u + v > 1.0f) {
-        return false;
-    }
-    float t = f * (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]);
-    return t > EPSILON; // Intersection with the triangle
+ * Checks if a point is inside the mesh using ray casting along CROSSING_DIRECTION.
+ * Queries go to the out-of-core mesh instead when one is set.
+ * @param point Pointer to the point vertex.
+ * @return True if the point is inside the mesh, false otherwise.
+ */
+bool MedialAxisTransformer::isPointInsideMesh(Vertex* point) {
+    if (outOfCore != nullptr) {
+        return outOfCore->isPointInside(point->coords);
+    }
+    prepareMesh();
+    int intersections = bvh.countCrossings(point->coords, CROSSING_DIRECTION);
+    return (intersections % 2) == 1; // Point is inside if intersections count is odd
 }
 
 /**
@@ -174,7 +426,7 @@ std::vector<Vertex*> MedialAxisTransformer::computeIntersectionPoints(const std:
         float* coords = new float[3];
         coords[0] = sampledPoints[i]->coords[0];
         coords[1] = sampledPoints[i]->coords[1];
-        coords[2] = sampledPoints[i]->coords[2] - 0.05; // Move inward along z-axis
+        coords[2] = sampledPoints[i]->coords[2] - inwardOffset; // Move inward along z-axis
         Vertex* intersectionPoint = new Vertex(sampledPoints[i]->idx, coords);
         intersectionPoints.push_back(intersectionPoint);
     }
@@ -183,64 +435,259 @@ std::vector<Vertex*> MedialAxisTransformer::computeIntersectionPoints(const std:
 
 /**
  * Performs binary search to find the maximal ball.
- * @param p Pointer to the start vertex.
- * @param q Pointer to the end vertex.
- * @param mesh Pointer to the mesh.
- * @return Pointer to the center vertex of the maximal ball.
- */
-Vertex* MedialAxisTransformer::binarySearchMaximalBall(Vertex* p, Vertex* q, Mesh* mesh) {
-    Vertex* mid = nullptr;
-    float* coords = new float[3];
-    while (true) {
-        coords[0] = (p->coords[0] + q->coords[0]) / 2.0f;
-        coords[1] = (p->coords[1] + q->coords[1]) / 2.0f;
-        coords[2] = (p->coords[2] + q->coords[2]) / 2.0f;
-        mid = new Vertex(-1, coords); // -1 is temporary index, not used
-        if (isPointInsideMesh(mid, mesh)) {
-            p = mid;
-        }
-        else {
-            q = mid;
-        }
-        // Check for convergence
-        if (std::sqrt(
-            (p->coords[0] - q->coords[0]) * (p->coords[0] - q->coords[0]) +
-            (p->coords[1] - q->coords[1]) * (p->coords[1] - q->coords[1]) +
-            (p->coords[2] - q->coords[2]) * (p->coords[2] - q->coords[2])
-        ) < 0.001f) { // Convergence threshold
-            break;
-        }
+ * Halves the bracket until it is shorter than the tolerance; the center is its inner end.
+ * The tolerance is raised to a few float steps of the coordinates, below which the midpoint stops moving.
+ * @param inside Inner end of the bracket, updated in place.
+ * @param outside Outer end of the bracket, updated in place.
+ */
+void MedialAxisTransformer::binarySearchMaximalBall(float* inside, float* outside) {
+    // The probe lives on the stack so the loop does not allocate
+    float midCoords[3];
+    Vertex mid(-1, midCoords); // -1 is temporary index, not used
+    float extent = 0.0f;
+    for (int k = 0; k < 3; ++k) {
+        extent = std::max(extent, std::max(std::fabs(inside[k]), std::fabs(outside[k])));
+    }
+    float threshold = std::max(tolerance, 4.0f * FLT_EPSILON * extent + FLT_MIN);
+    while (std::sqrt(
+        (inside[0] - outside[0]) * (inside[0] - outside[0]) +
+        (inside[1] - outside[1]) * (inside[1] - outside[1]) +
+        (inside[2] - outside[2]) * (inside[2] - outside[2])
+    ) >= threshold) { // Convergence threshold
+        midCoords[0] = (inside[0] + outside[0]) / 2.0f;
+        midCoords[1] = (inside[1] + outside[1]) / 2.0f;
+        midCoords[2] = (inside[2] + outside[2]) / 2.0f;
+        float* end = isPointInsideMesh(&mid) ? inside : outside;
+        end[0] = midCoords[0];
+        end[1] = midCoords[1];
+        end[2] = midCoords[2];
     }
-    return p;
 }
 
 /**
  * Computes the maximal balls using binary search.
+ * With Morton ordering enabled, spatially close queries are solved one after another and
+ * the results are written back to the positions of their input points. The writer gets them in input order:
+ * ball i is written as soon as balls 0 to i are solved, so without Morton ordering every ball is written right away.
+ * The bracket of every query is stored under its sample index; a query seen before with the same
+ * start point continues from its bracket, which costs nothing unless the tolerance was tightened.
  * @param intersectionPoints Vector of intersection points.
  * @param radii Vector to store the radii of the maximal balls.
  * @return A vector of vertices representing the centers of the maximal balls.
  */
 std::vector<Vertex*> MedialAxisTransformer::computeMaximalBalls(const std::vector<Vertex*>& intersectionPoints, std::vector<float>& radii) {
-    std::vector<Vertex*> maximalBalls;
-    for (size_t i = 0; i < intersectionPoints.size(); ++i) {
+    std::vector<Vertex*> maximalBalls(intersectionPoints.size());
+    size_t firstRadius = radii.size();
+    radii.resize(firstRadius + intersectionPoints.size());
+
+    std::vector<int> order;
+    if (useMortonOrder) {
+        order = mortonOrder(intersectionPoints);
+    }
+    else {
+        for (size_t i = 0; i < intersectionPoints.size(); ++i) {
+            order.push_back(static_cast<int>(i));
+        }
+    }
+
+    size_t written = 0;
+    for (size_t j = 0; j < order.size(); ++j) {
+        size_t i = order[j];
         Vertex* p = intersectionPoints[i];
+        Bracket fresh;
+        Bracket* bracket = &fresh;
+        if (outOfCore == nullptr) {
+            // Streamed samples are never revisited, so only in-memory runs keep their brackets
+            bracket = &brackets[p->idx];
+        }
+        if (bracket == &fresh || !std::equal(p->coords, p->coords + 3, bracket->start)) {
+            std::copy(p->coords, p->coords + 3, bracket->start);
+            std::copy(p->coords, p->coords + 3, bracket->inside);
+            std::copy(p->coords, p->coords + 3, bracket->outside);
+            bracket->outside[2] -= searchDistance; // Move far inward
+        }
+        binarySearchMaximalBall(bracket->inside, bracket->outside);
+
         float* coords = new float[3];
-        coords[0] = p->coords[0];
-        coords[1] = p->coords[1];
-        coords[2] = p->coords[2] - 1.0f; // Move far inward
-        Vertex* q = new Vertex(p->idx, coords);
-        Vertex* center = binarySearchMaximalBall(p, q, mesh);
-        maximalBalls.push_back(center);
+        std::copy(bracket->inside, bracket->inside + 3, coords);
+        Vertex* center = new Vertex(-1, coords);
+        maximalBalls[i] = center;
         float radius = std::sqrt(
             (p->coords[0] - center->coords[0]) * (p->coords[0] - center->coords[0]) +
             (p->coords[1] - center->coords[1]) * (p->coords[1] - center->coords[1]) +
             (p->coords[2] - center->coords[2]) * (p->coords[2] - center->coords[2])
         );
-        radii.push_back(radius * 0.5); // Reduce the radius to fit within the mesh
+        radii[firstRadius + i] = radius * radiusScale; // Reduce the radius to fit within the mesh
+
+        // Written in input order, so the files and their skeleton edges do not depend on the query order;
+        // every ball goes out as soon as all the balls before it are solved
+        while (written < maximalBalls.size() && maximalBalls[written] != nullptr) {
+            emitBall(maximalBalls[written]->coords, radii[firstRadius + written], static_cast<int>(written));
+            ++written;
+        }
+    }
+    return maximalBalls;
+}
+
+/**
+ * Computes the maximal balls as the interior Voronoi poles of the sampled points.
+ * The Voronoi vertices of a sample are the circumcenters of its incident Delaunay tetrahedra;
+ * the farthest one on the inner side of the surface is its interior pole, and the distance
+ * to the sample is the radius of the pole ball (power crust style).
+ * Ball i belongs to sample i; a sample without an interior pole gets a ball of radius 0 at the sample.
+ * @param sampledPoints Vector of sampled points carrying outward normals.
+ * @param radii Vector to store the radii of the maximal balls.
+ * @return A vector of vertices representing the centers of the maximal balls.
+ */
+std::vector<Vertex*> MedialAxisTransformer::computeVoronoiPoleBalls(const std::vector<Vertex*>& sampledPoints, std::vector<float>& radii) {
+    std::vector<Vertex*> maximalBalls;
+    Delaunay delaunay(sampledPoints);
+
+    // Circumcenters of slivers can lie far away; no interior pole leaves the bounds of the samples
+    float minCoords[3], maxCoords[3];
+    computeBounds(sampledPoints, minCoords, maxCoords);
+
+    // Farthest interior Voronoi vertex of each sample
+    std::vector<double> poles(3 * sampledPoints.size());
+    std::vector<double> poleRadii(sampledPoints.size(), -1.0);
+    const std::vector<Delaunay::Tetrahedron>& tets = delaunay.getTetrahedra();
+    for (size_t t = 0; t < tets.size(); ++t) {
+        if (!delaunay.isFinite(tets[t])) {
+            continue;
+        }
+        double center[3];
+        double radius = delaunay.circumsphere(tets[t], center);
+        if (!(radius < HUGE_VAL)) {
+            continue; // Flat tetrahedron
+        }
+        if (center[0] < minCoords[0] || center[1] < minCoords[1] || center[2] < minCoords[2] ||
+            center[0] > maxCoords[0] || center[1] > maxCoords[1] || center[2] > maxCoords[2]) {
+            continue;
+        }
+        for (int k = 0; k < 4; ++k) {
+            int s = tets[t].v[k];
+            const float* c = sampledPoints[s]->coords;
+            const float* n = sampledPoints[s]->normals;
+            if (n == nullptr) {
+                continue;
+            }
+            double inward = -((center[0] - c[0]) * n[0] + (center[1] - c[1]) * n[1] + (center[2] - c[2]) * n[2]);
+            if (inward > 0.0 && radius > poleRadii[s]) {
+                poleRadii[s] = radius;
+                poles[3 * s] = center[0];
+                poles[3 * s + 1] = center[1];
+                poles[3 * s + 2] = center[2];
+            }
+        }
+    }
+
+    for (size_t i = 0; i < sampledPoints.size(); ++i) {
+        float* coords = new float[3];
+        if (poleRadii[i] < 0.0) {
+            // No Voronoi vertex on the inner side: an empty ball at the sample keeps ball i on sample i
+            std::copy(sampledPoints[i]->coords, sampledPoints[i]->coords + 3, coords);
+            poleRadii[i] = 0.0;
+        }
+        else {
+            coords[0] = static_cast<float>(poles[3 * i]);
+            coords[1] = static_cast<float>(poles[3 * i + 1]);
+            coords[2] = static_cast<float>(poles[3 * i + 2]);
+        }
+        maximalBalls.push_back(new Vertex(sampledPoints[i]->idx, coords));
+        radii.push_back(static_cast<float>(poleRadii[i]));
+        emitBall(coords, radii.back(), static_cast<int>(i));
     }
     return maximalBalls;
 }
 
+/**
+ * Computes the maximal balls from the Euclidean distance transform of the voxelized mesh.
+ * No samples are used; every voxel on the ridge of the distance field yields one ball.
+ * The balls come in voxel scan order, so they are written without skeleton edges.
+ * The cost is linear in the number of voxels; the triangles are only visited once, to voxelize the mesh.
+ * @param radii Vector to store the radii of the maximal balls.
+ * @return A vector of vertices representing the centers of the maximal balls.
+ */
+std::vector<Vertex*> MedialAxisTransformer::computeDistanceTransformBalls(std::vector<float>& radii) {
+    std::vector<Vertex*> maximalBalls;
+    if (mesh == nullptr || mesh->tris.empty()) {
+        return maximalBalls;
+    }
+    DistanceTransform distanceTransform(voxelResolution);
+    distanceTransform.voxelize(mesh);
+    distanceTransform.computeDistances();
+
+    // Radii are appended to what the caller passed in, the centers start empty
+    std::vector<float> centers;
+    size_t firstRadius = radii.size();
+    distanceTransform.extractMedialVoxels(centers, radii);
+    for (size_t i = 0; i < centers.size() / 3; ++i) {
+        float* coords = new float[3];
+        std::copy(&centers[3 * i], &centers[3 * i] + 3, coords);
+        maximalBalls.push_back(new Vertex(static_cast<int>(i), coords));
+        emitBall(coords, radii[firstRadius + i], static_cast<int>(i), false);
+    }
+    return maximalBalls;
+}
+
+/**
+ * Splits the sample count of samplePoints between the chunks of the out-of-core mesh in proportion to their area.
+ * Fractional shares are rounded up or down at random so that the expected counts are exact;
+ * the rounding of chunk c only depends on the seed and c.
+ * @return Number of samples for each chunk.
+ */
+std::vector<int> MedialAxisTransformer::computeChunkQuotas() {
+    std::vector<int> quotas(outOfCore->getNumChunks(), 0);
+    double totalArea = outOfCore->getTotalArea();
+    int numSamples = sampleCount > 0 ? sampleCount : outOfCore->getNumVertices() / 4;
+    for (size_t c = 0; c < quotas.size() && totalArea > 0.0; ++c) {
+        double share = numSamples * outOfCore->getChunkArea(static_cast<int>(c)) / totalArea;
+        quotas[c] = static_cast<int>(share);
+        // Stream 3 is unused by the samples themselves
+        if (sampleRandom(seed, static_cast<int>(c), 3) < share - quotas[c]) {
+            quotas[c]++;
+        }
+    }
+    return quotas;
+}
+
+/**
+ * Computes the maximal balls of the out-of-core mesh one chunk at a time and passes them to the writer.
+ * The samples of a chunk are solved and released before the next chunk is sampled, so memory
+ * use is bounded by the chunk cache budget plus one chunk worth of samples.
+ * Chunks are always solved by bisection, whatever the engine: the Voronoi poles of one chunk's samples
+ * are wrong near its borders, where the cells are cut by samples of the neighbouring chunks.
+ * @return Number of maximal balls computed.
+ */
+size_t MedialAxisTransformer::streamMaximalBalls() {
+    size_t numBalls = 0;
+    if (outOfCore == nullptr) {
+        return numBalls;
+    }
+    std::vector<int> quotas = computeChunkQuotas();
+    firstSample = 0;
+    for (int c = 0; c < outOfCore->getNumChunks(); ++c) {
+        std::vector<Vertex*> sampledPoints = outOfCore->sampleChunk(c, quotas[c], firstSample, seed);
+        std::vector<float> radii;
+        std::vector<Vertex*> maximalBalls;
+        std::vector<Vertex*> intersectionPoints = computeIntersectionPoints(sampledPoints);
+        maximalBalls = computeMaximalBalls(intersectionPoints, radii);
+        numBalls += maximalBalls.size();
+        firstSample += static_cast<int>(sampledPoints.size());
+
+        std::vector<Vertex*>* batches[3] = { &sampledPoints, &intersectionPoints, &maximalBalls };
+        for (int b = 0; b < 3; ++b) {
+            for (size_t i = 0; i < batches[b]->size(); ++i) {
+                delete[] (*batches[b])[i]->coords;
+                delete[] (*batches[b])[i]->normals;
+                delete (*batches[b])[i];
+            }
+        }
+    }
+    firstSample = 0;
+    return numBalls;
+}
+
 /**
  * Transforms the mesh and prepares the visual elements.
  * @param painter Pointer to the Painter object for rendering.
@@ -249,17 +696,32 @@ std::vector<Vertex*> MedialAxisTransformer::computeMaximalBalls(const std::vecto
 SoSeparator* MedialAxisTransformer::transform(Painter* painter) {
     SoSeparator* res = new SoSeparator;
 
+    std::vector<float> radii;
+    std::vector<Vertex*> maximalBalls;
+    if (engine == MatEngine::DISTANCE_TRANSFORM) {
+        // Steps 1-3: Take the ridge voxels of the distance transform as maximal balls
+        // The voxels come in scan order, so they are drawn as points rather than joined by lines
+        maximalBalls = computeDistanceTransformBalls(radii);
+        res->addChild(painter->getSampledPointsSep(maximalBalls));
+        return res;
+    }
+
     // Step 1: Sample points on the mesh
     std::vector<Vertex*> sampledPoints = samplePoints();
     res->addChild(painter->getSampledPointsSep(sampledPoints));
 
-    // Step 2: Compute intersection points
-    std::vector<Vertex*> intersectionPoints = computeIntersectionPoints(sampledPoints);
-    res->addChild(painter->getSampledPointsSep(intersectionPoints));
+    if (engine == MatEngine::VORONOI_POLES) {
+        // Steps 2-3: Take the interior Voronoi poles of the samples as maximal balls
+        maximalBalls = computeVoronoiPoleBalls(sampledPoints, radii);
+    }
+    else {
+        // Step 2: Compute intersection points
+        std::vector<Vertex*> intersectionPoints = computeIntersectionPoints(sampledPoints);
+        res->addChild(painter->getSampledPointsSep(intersectionPoints));
 
-    // Step 3: Compute maximal balls
-    std::vector<float> radii;
-    std::vector<Vertex*> maximalBalls = computeMaximalBalls(intersectionPoints, radii);
+        // Step 3: Compute maximal balls
+        maximalBalls = computeMaximalBalls(intersectionPoints, radii);
+    }
     //res->addChild(painter->getMaximalBallsSep(maximalBalls, radii));
 
     // Step 4: Visualize the medial axis
@@ -2,10 +2,33 @@
 
 #include "Mesh.h"
 #include "Painter.h"
+#include "MatWriter.h"
+#include "OutOfCoreMesh.h"
+#include "Bvh.h"
+#include <unordered_map>
 #include <vector>
 
+/**
+ * Algorithms available for computing the maximal balls.
+ */
+enum class MatEngine {
+    BISECTION,     ///< Per-sample binary search along the inward direction using the inside test.
+    VORONOI_POLES, ///< Interior Voronoi poles of the Delaunay tetrahedralization of the samples.
+    DISTANCE_TRANSFORM ///< Ridge voxels of the Euclidean distance transform of the voxelized mesh; in-memory meshes only.
+};
+
+/**
+ * Ways of placing the surface samples.
+ */
+enum class SamplingMode {
+    RANDOM,       ///< Independent samples with density proportional to area.
+    POISSON_DISK  ///< Blue-noise samples no closer than a minimum spacing, selected from random candidates.
+};
+
 /**
  * Class for performing Medial Axis Transform on a 3D mesh.
+ * State derived from the mesh and the bisection brackets of solved samples are kept across calls,
+ * so repeated runs with more samples or a tighter tolerance only do the new work.
  */
 class MedialAxisTransformer {
 public:
@@ -15,6 +38,97 @@ public:
      */
     MedialAxisTransformer(Mesh* mesh);
 
+    /**
+     * Selects the algorithm used by transform to compute the maximal balls.
+     * @param engine The engine to use.
+     */
+    void setEngine(MatEngine engine);
+
+    /**
+     * Enables processing the queries of computeMaximalBalls in Morton order.
+     * Results are still returned and passed to the writer in the order of the input points.
+     * @param enabled True to sort the queries by Morton code.
+     */
+    void setMortonOrder(bool enabled);
+
+    /**
+     * Sets the number of surface samples drawn by samplePoints.
+     * Sample i is the same for every count, so raising the count only adds new samples.
+     * @param count Number of samples, or 0 for a quarter of the vertex count.
+     */
+    void setNumSamples(int count);
+
+    /**
+     * Selects how samplePoints places the samples.
+     * Poisson-disk samples cover the surface evenly, so fewer of them give the same coverage as random ones.
+     * @param mode The sampling mode.
+     */
+    void setSampling(SamplingMode mode);
+
+    /**
+     * Sets the minimum distance between Poisson-disk samples.
+     * @param spacing The spacing, or 0 to derive it from the sample count.
+     */
+    void setSampleSpacing(float spacing);
+
+    /**
+     * Sets the grid used by the distance transform engine.
+     * @param resolution Number of voxels along the longest side of the bounding box; DistanceTransform clamps it to [1, 1024].
+     */
+    void setVoxelResolution(int resolution);
+
+    /**
+     * Sets the seed from which every sample is drawn. Changing it discards the solved samples.
+     * @param seed The seed.
+     */
+    void setSeed(unsigned int seed);
+
+    /**
+     * Sets the convergence threshold of the binary search for the maximal ball centers.
+     * Solved samples are refined from their stored bracket when the tolerance is tightened
+     * and reused as they are when it is loosened. Zero, negative or denormal values act as the smallest
+     * interval the float coordinates can resolve.
+     * @param tolerance Length of the final search interval.
+     */
+    void setTolerance(float tolerance);
+
+    /**
+     * Sets how far the samples are moved inward to start the search. Changing it discards the solved samples.
+     * @param offset The inward offset.
+     */
+    void setInwardOffset(float offset);
+
+    /**
+     * Sets the length of the segment searched for the maximal ball center. Changing it discards the solved samples.
+     * @param distance The search distance.
+     */
+    void setSearchDistance(float distance);
+
+    /**
+     * Discards the state derived from the mesh and the solved samples. Call after modifying the mesh.
+     */
+    void invalidate();
+
+    /**
+     * Sets the factor applied to the search distance to obtain the radius of a bisection ball.
+     * @param scale The radius factor.
+     */
+    void setRadiusScale(float scale);
+
+    /**
+     * Sets a writer that receives the maximal balls in input order, each as soon as it and every ball before it are computed.
+     * Consecutive balls are joined by a skeleton edge, like the medial axis lines drawn by Painter,
+     * except those of the distance transform engine, which come in voxel scan order.
+     * @param writer Pointer to the writer, or nullptr to disable streaming output.
+     */
+    void setWriter(MatWriter* writer);
+
+    /**
+     * Makes the inside test and the sampling use an out-of-core mesh instead of the in-memory one.
+     * @param outOfCore Pointer to the opened out-of-core mesh, or nullptr to use the in-memory mesh.
+     */
+    void setOutOfCoreMesh(OutOfCoreMesh* outOfCore);
+
     /**
      * Samples points on the surface of the mesh.
      * @return A vector of sampled vertices.
@@ -36,6 +150,33 @@ public:
      */
     std::vector<Vertex*> computeMaximalBalls(const std::vector<Vertex*>& intersectionPoints, std::vector<float>& radii);
 
+    /**
+     * Computes the maximal balls as the interior Voronoi poles of the sampled points.
+     * Each sample whose Voronoi cell has a vertex on the inner side of the surface yields one ball;
+     * the others get a ball of radius 0 at the sample, so ball i always belongs to sample i.
+     * @param sampledPoints Vector of sampled points carrying outward normals.
+     * @param radii Vector to store the radii of the maximal balls.
+     * @return A vector of vertices representing the centers of the maximal balls.
+     */
+    std::vector<Vertex*> computeVoronoiPoleBalls(const std::vector<Vertex*>& sampledPoints, std::vector<float>& radii);
+
+    /**
+     * Computes the maximal balls from the Euclidean distance transform of the voxelized mesh.
+     * No samples are used; every voxel on the ridge of the distance field yields one ball.
+     * The balls come in voxel scan order, so they are written without skeleton edges.
+     * @param radii Vector to store the radii of the maximal balls.
+     * @return A vector of vertices representing the centers of the maximal balls.
+     */
+    std::vector<Vertex*> computeDistanceTransformBalls(std::vector<float>& radii);
+
+    /**
+     * Computes the maximal balls of the out-of-core mesh one chunk at a time and passes them to the writer.
+     * Only one chunk worth of samples and balls is held in memory at a time.
+     * Chunks are always solved by bisection, since Voronoi poles need the samples of the neighbouring chunks.
+     * @return Number of maximal balls computed.
+     */
+    size_t streamMaximalBalls();
+
     /**
      * Transforms the mesh and prepares the visual elements.
      * @param painter Pointer to the Painter object for rendering.
@@ -45,31 +186,86 @@ public:
 
 private:
     Mesh* mesh; ///< Pointer to the input mesh.
+    MatEngine engine; ///< Algorithm used to compute the maximal balls.
+    bool useMortonOrder; ///< Whether computeMaximalBalls visits its queries in Morton order.
+    MatWriter* writer; ///< Receives the balls as they are produced; may be nullptr.
+    OutOfCoreMesh* outOfCore; ///< Out-of-core mesh used instead of mesh when set; may be nullptr.
+    int firstSample; ///< Index of the first sample of the current batch, added to the sample indices passed to the writer.
+    int sampleCount; ///< Number of samples to draw; 0 for a quarter of the vertex count.
+    SamplingMode sampling; ///< How the samples are placed.
+    float sampleSpacing; ///< Minimum distance between Poisson-disk samples; 0 to derive it from the sample count.
+    int voxelResolution; ///< Voxels along the longest side of the grid of the distance transform engine.
+    unsigned int seed; ///< Seed of the per-sample random numbers.
+    float tolerance; ///< Convergence threshold of the binary search.
+    float radiusScale; ///< Factor from search distance to bisection ball radius.
+    float inwardOffset; ///< Distance the samples are moved inward to start the search.
+    float searchDistance; ///< Length of the searched segment.
 
     /**
-     * Checks if a point is inside the mesh using ray casting.
-     * @param point Pointer to the point vertex.
-     * @param mesh Pointer to the mesh.
-     * @return True if the point is inside the mesh, false otherwise.
+     * Bisection state of a solved sample. The center is inside; the bracket is refined until shorter than the tolerance.
+     */
+    struct Bracket {
+        float start[3]; ///< Start point the bracket was computed for.
+        float inside[3]; ///< Inner end of the bracket.
+        float outside[3]; ///< Outer end of the bracket.
+    };
+
+    bool prepared; ///< Whether the state below is up to date with the mesh.
+    std::vector<double> areaSums; ///< Running sum of the triangle areas.
+    std::vector<float> triangleNormals; ///< Outward unit normal of each triangle.
+    Bvh bvh; ///< Hierarchy over the mesh triangles for the inside test.
+    std::unordered_map<int, Bracket> brackets; ///< Solved samples keyed by sample index.
+
+    /**
+     * Computes the area table, the outward normals and the BVH of the mesh unless they are up to date.
+     */
+    void prepareMesh();
+
+    /**
+     * Draws candidate sample i: a point with density proportional to area, and the triangle it lies on.
+     * @param sample Index of the sample.
+     * @param coords Array of 3 floats to store the point.
+     * @return Index of the triangle.
+     */
+    size_t drawSample(int sample, float* coords);
+
+    /**
+     * Selects Poisson-disk samples among the candidates drawn by drawSample.
+     * Without a spacing, the spacing is estimated from the area and the sample count and then bisected until
+     * at most 1% more samples than wanted are accepted; the surplus is thinned where the samples are densest.
+     * @param numSamples Number of samples wanted.
+     * @return Indices of the selected candidates in increasing order.
+     */
+    std::vector<int> selectPoissonSamples(int numSamples);
+
+    /**
+     * Splits the sample count of samplePoints between the chunks of the out-of-core mesh in proportion to their area.
+     * @return Number of samples for each chunk.
      */
-    bool isPointInsideMesh(Vertex* point, Mesh* mesh);
+    std::vector<int> computeChunkQuotas();
 
     /**
-     * Performs ray-triangle intersection test.
-     * @param orig Origin point of the ray.
-     * @param v0 Vertex 0 of the triangle.
-     * @param v1 Vertex 1 of the triangle.
-     * @param v2 Vertex 2 of the triangle.
-     * @return True if the ray intersects the triangle, false otherwise.
+     * Passes a computed ball to the writer, if any, together with the skeleton edge to the previous ball.
+     * @param center Coordinates of the ball center.
+     * @param radius Radius of the ball.
+     * @param sample Index of the sample the ball was computed from.
+     * @param linked False to write the ball without an edge, for balls whose order says nothing about adjacency.
+     */
+    void emitBall(const float* center, float radius, int sample, bool linked = true);
+
+    /**
+     * Checks if a point is inside the mesh using ray casting along CROSSING_DIRECTION.
+     * @param point Pointer to the point vertex.
+     * @return True if the point is inside the mesh, false otherwise.
      */
-    bool rayIntersectsTriangle(const float* orig, const float* v0, const float* v1, const float* v2);
+    bool isPointInsideMesh(Vertex* point);
 
     /**
      * Performs binary search to find the maximal ball.
-     * @param p Pointer to the start vertex.
-     * @param q Pointer to the end vertex.
-     * @param mesh Pointer to the mesh.
-     * @return Pointer to the center vertex of the maximal ball.
+     * Halves the bracket until it is shorter than the tolerance; the center is its inner end.
+     * The tolerance is raised to a few float steps of the coordinates, below which the midpoint stops moving.
+     * @param inside Inner end of the bracket, updated in place.
+     * @param outside Outer end of the bracket, updated in place.
      */
-    Vertex* binarySearchMaximalBall(Vertex* p, Vertex* q, Mesh* mesh);
+    void binarySearchMaximalBall(float* inside, float* outside);
 };
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include <algorithm>
 
 
 void Mesh::loadOff(char* name)
@@ -81,6 +82,51 @@ void Mesh::createCube(float sideLen)
 	addTriangle(0, 5, 4);
 }
 
+void Mesh::createShape(const ShapeSpec& spec)
+{
+	//synthetic sphere, torus or capsule, optionally with noise; see ShapeGenerator.h
+	vector< float > coords;
+	vector< int > triangles;
+	generateShape(spec, coords, triangles);
+	loadArrays(coords, triangles);
+}
+
+void Mesh::loadArrays(const vector< float >& coords, const vector< int >& triangles)
+{
+	//bulk version of addVertex/addTriangle: edges are found by sorting vertex pairs instead of scanning vertLists,
+	//so large meshes build in O(n log n)
+
+	int vBase = verts.size(), tBase = tris.size(), nVerts = coords.size() / 3, nTris = triangles.size() / 3;
+	verts.reserve(vBase + nVerts);
+	tris.reserve(tBase + nTris);
+	for (int v = 0; v < nVerts; v++)
+		addVertex(coords[3 * v], coords[3 * v + 1], coords[3 * v + 2]);
+
+	vector< unsigned long long > pairs(3 * (size_t)nTris);
+	for (int t = 0; t < nTris; t++)
+	{
+		int v[3] = { vBase + triangles[3 * t], vBase + triangles[3 * t + 1], vBase + triangles[3 * t + 2] };
+		tris.push_back(new Triangle(tBase + t, v[0], v[1], v[2]));
+		for (int k = 0; k < 3; k++)
+		{
+			verts[v[k]]->triList.push_back(tBase + t);
+			unsigned long long a = min(v[k], v[(k + 1) % 3]), b = max(v[k], v[(k + 1) % 3]);
+			pairs[3 * (size_t)t + k] = (a << 32) | b;
+		}
+	}
+
+	sort(pairs.begin(), pairs.end());
+	pairs.erase(unique(pairs.begin(), pairs.end()), pairs.end());
+	edges.reserve(edges.size() + pairs.size());
+	for (size_t e = 0; e < pairs.size(); e++)
+	{
+		int v1 = (int)(pairs[e] >> 32), v2 = (int)(pairs[e] & 0xffffffffULL);
+		verts[v1]->vertList.push_back(v2);
+		verts[v2]->vertList.push_back(v1);
+		addEdge(v1, v2);
+	}
+}
+
 void Mesh::addTriangle(int v1, int v2, int v3)
 {
 	int idx = tris.size();
@@ -3,6 +3,7 @@
 
 #include <iostream>
 #include <vector>
+#include "ShapeGenerator.h"
 
 using namespace std;
 
@@ -15,7 +16,7 @@ struct Vertex
 	vector< int > triList;
 	vector< int > edgeList;
 
-	Vertex(int i, float* c) : idx(i), coords(c) {};
+	Vertex(int i, float* c) : idx(i), coords(c), normals(nullptr) {};
 };
 
 struct Edge
@@ -66,6 +67,8 @@ public:
 
 	Mesh() {};
 	void createCube(float side);
+	void createShape(const ShapeSpec& spec);
+	void loadArrays(const vector< float >& coords, const vector< int >& triangles);
 	void loadOff(char* name);
 	void windingNumberByYusufSahillioglu(Point* pnt);
 };
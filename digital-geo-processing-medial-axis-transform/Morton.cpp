@@ -0,0 +1,99 @@
+#include "Morton.h"
+#include <algorithm>
+#include <utility>
+
+/**
+ * Spreads the lower 21 bits of a value so that there are two zero bits between each of them.
+ * @param x The value to spread.
+ * @return The spread value.
+ */
+static unsigned long long spreadBits(unsigned long long x) {
+    x &= 0x1fffff;
+    x = (x | (x << 32)) & 0x1f00000000ffffULL;
+    x = (x | (x << 16)) & 0x1f0000ff0000ffULL;
+    x = (x | (x << 8)) & 0x100f00f00f00f00fULL;
+    x = (x | (x << 4)) & 0x10c30c30c30c30c3ULL;
+    x = (x | (x << 2)) & 0x1249249249249249ULL;
+    return x;
+}
+
+/**
+ * Computes the axis-aligned bounding box of a set of points.
+ * @param points Vector of points.
+ * @param minCoords Array of 3 floats to store the minimum corner.
+ * @param maxCoords Array of 3 floats to store the maximum corner.
+ */
+void computeBounds(const std::vector<Vertex*>& points, float* minCoords, float* maxCoords) {
+    for (int k = 0; k < 3; ++k) {
+        minCoords[k] = points.empty() ? 0.0f : points[0]->coords[k];
+        maxCoords[k] = minCoords[k];
+    }
+    for (size_t i = 1; i < points.size(); ++i) {
+        for (int k = 0; k < 3; ++k) {
+            minCoords[k] = std::min(minCoords[k], points[i]->coords[k]);
+            maxCoords[k] = std::max(maxCoords[k], points[i]->coords[k]);
+        }
+    }
+}
+
+/**
+ * Computes the 63-bit Morton (Z-order) code of a point, quantized to 21 bits per axis inside a bounding box.
+ * @param point Coordinates of the point.
+ * @param minCoords Minimum corner of the bounding box.
+ * @param maxCoords Maximum corner of the bounding box.
+ * @return The Morton code.
+ */
+unsigned long long mortonCode(const float* point, const float* minCoords, const float* maxCoords) {
+    const float cells = static_cast<float>((1 << 21) - 1);
+    unsigned long long code = 0;
+    for (int k = 0; k < 3; ++k) {
+        float range = maxCoords[k] - minCoords[k];
+        float t = range > 0.0f ? (point[k] - minCoords[k]) / range : 0.0f;
+        t = std::min(std::max(t, 0.0f), 1.0f);
+        code |= spreadBits(static_cast<unsigned long long>(t * cells)) << k;
+    }
+    return code;
+}
+
+/**
+ * Computes the permutation that sorts points by their Morton code.
+ * @param coords Flat vector of xyz coordinates.
+ * @return Indices of the points in Morton order.
+ */
+std::vector<int> mortonOrder(const std::vector<float>& coords) {
+    size_t n = coords.size() / 3;
+    float minCoords[3] = { 0.0f, 0.0f, 0.0f }, maxCoords[3] = { 0.0f, 0.0f, 0.0f };
+    for (size_t i = 0; i < n; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            if (i == 0 || coords[3 * i + k] < minCoords[k]) minCoords[k] = coords[3 * i + k];
+            if (i == 0 || coords[3 * i + k] > maxCoords[k]) maxCoords[k] = coords[3 * i + k];
+        }
+    }
+
+    std::vector<std::pair<unsigned long long, int> > keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = std::make_pair(mortonCode(&coords[3 * i], minCoords, maxCoords), static_cast<int>(i));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<int> order(n);
+    for (size_t i = 0; i < n; ++i) {
+        order[i] = keys[i].second;
+    }
+    return order;
+}
+
+/**
+ * Computes the permutation that sorts points by their Morton code.
+ * @param points Vector of points.
+ * @return Indices into points in Morton order.
+ */
+std::vector<int> mortonOrder(const std::vector<Vertex*>& points) {
+    std::vector<float> coords(3 * points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        coords[3 * i] = points[i]->coords[0];
+        coords[3 * i + 1] = points[i]->coords[1];
+        coords[3 * i + 2] = points[i]->coords[2];
+    }
+    return mortonOrder(coords);
+}
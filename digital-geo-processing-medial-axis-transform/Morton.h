@@ -0,0 +1,35 @@
+#pragma once
+
+#include "Mesh.h"
+#include <vector>
+
+/**
+ * Computes the axis-aligned bounding box of a set of points.
+ * @param points Vector of points.
+ * @param minCoords Array of 3 floats to store the minimum corner.
+ * @param maxCoords Array of 3 floats to store the maximum corner.
+ */
+void computeBounds(const std::vector<Vertex*>& points, float* minCoords, float* maxCoords);
+
+/**
+ * Computes the 63-bit Morton (Z-order) code of a point, quantized to 21 bits per axis inside a bounding box.
+ * @param point Coordinates of the point.
+ * @param minCoords Minimum corner of the bounding box.
+ * @param maxCoords Maximum corner of the bounding box.
+ * @return The Morton code.
+ */
+unsigned long long mortonCode(const float* point, const float* minCoords, const float* maxCoords);
+
+/**
+ * Computes the permutation that sorts points by their Morton code.
+ * @param coords Flat vector of xyz coordinates.
+ * @return Indices of the points in Morton order.
+ */
+std::vector<int> mortonOrder(const std::vector<float>& coords);
+
+/**
+ * Computes the permutation that sorts points by their Morton code.
+ * @param points Vector of points.
+ * @return Indices into points in Morton order.
+ */
+std::vector<int> mortonOrder(const std::vector<Vertex*>& points);
@@ -0,0 +1,715 @@
+#include "OutOfCoreMesh.h"
+#include "SampleRandom.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#ifdef _WIN32
+#define seekFile _fseeki64
+#define statFile _stat64
+typedef struct _stat64 FileStatus;
+#else
+#define seekFile fseeko
+#define statFile stat
+typedef struct stat FileStatus;
+#endif
+
+/**
+ * Number of vertices per page of the vertex file read back during build.
+ */
+static const int PAGE_SIZE = 65536;
+
+/**
+ * Magic number at the start of the chunk index file.
+ */
+static const int INDEX_MAGIC = 0x4454414d;
+
+/**
+ * Upper bound of the bytes held by the BVH of a chunk per triangle: its corners and at most
+ * one node, since the leaves of a hierarchy of two or more triangles hold at least two.
+ */
+static const size_t CHUNK_BYTES_PER_TRIANGLE = 9 * sizeof(float) + sizeof(Bvh::Node);
+
+/**
+ * Maximum number of grid cells per axis of the first partition in build.
+ */
+static const int MAX_GRID_CELLS = 16;
+
+/**
+ * Number of triangles read or written at a time when a bucket is split.
+ */
+static const size_t BLOCK_TRIANGLES = 4096;
+
+/**
+ * Number of histogram bins used to find the median centroid of a bucket.
+ */
+static const int SPLIT_BINS = 1024;
+
+/**
+ * Random access to the vertex file written during build, through an LRU cache of fixed-size pages.
+ */
+class VertexPages {
+public:
+    VertexPages(FILE* file, int numVertices, size_t memoryBudget)
+        : file(file), numVertices(numVertices), pages((numVertices + PAGE_SIZE - 1) / PAGE_SIZE), lruPos(pages.size()) {
+        maxPages = std::max<size_t>(1, memoryBudget / (3 * sizeof(float) * PAGE_SIZE));
+    }
+
+    /**
+     * Copies the coordinates of a vertex.
+     * @param v Index of the vertex.
+     * @param coords Array of 3 floats to store the coordinates.
+     * @return False if the vertex could not be read.
+     */
+    bool get(int v, float* coords) {
+        if (v < 0 || v >= numVertices) {
+            return false;
+        }
+        int page = v / PAGE_SIZE;
+        if (pages[page].empty()) {
+            if (lru.size() >= maxPages) {
+                int victim = lru.back();
+                lru.pop_back();
+                std::vector<float>().swap(pages[victim]);
+            }
+            int first = page * PAGE_SIZE;
+            size_t count = static_cast<size_t>(3) * std::min(PAGE_SIZE, numVertices - first);
+            pages[page].resize(count);
+            if (seekFile(file, static_cast<long long>(first) * 3 * sizeof(float), SEEK_SET) != 0 ||
+                std::fread(&pages[page][0], sizeof(float), count, file) != count) {
+                std::vector<float>().swap(pages[page]);
+                return false;
+            }
+            lru.push_front(page);
+            lruPos[page] = lru.begin();
+        }
+        else {
+            lru.splice(lru.begin(), lru, lruPos[page]);
+        }
+        const float* c = &pages[page][3 * (v - page * PAGE_SIZE)];
+        coords[0] = c[0];
+        coords[1] = c[1];
+        coords[2] = c[2];
+        return true;
+    }
+
+private:
+    FILE* file;
+    int numVertices;
+    size_t maxPages;
+    std::vector<std::vector<float> > pages;
+    std::list<int> lru;
+    std::vector<std::list<int>::iterator> lruPos;
+};
+
+/**
+ * Computes the cross product of two edges of a triangle stored as 9 floats.
+ * Its length is twice the area and its direction follows the winding order.
+ * @param tri The triangle corners.
+ * @param cross Array of 3 doubles to store the cross product.
+ */
+static void triangleCross(const float* tri, double* cross) {
+    double a[3] = { tri[3] - tri[0], tri[4] - tri[1], tri[5] - tri[2] };
+    double b[3] = { tri[6] - tri[0], tri[7] - tri[1], tri[8] - tri[2] };
+    cross[0] = a[1] * b[2] - a[2] * b[1];
+    cross[1] = a[2] * b[0] - a[0] * b[2];
+    cross[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+/**
+ * Appends the triangles buffered for a chunk to its bucket file and empties the buffer.
+ * @param path Path of the bucket file.
+ * @param bucket Buffered triangle corners.
+ * @return True on success.
+ */
+static bool appendBucket(const std::string& path, std::vector<float>& bucket) {
+    if (bucket.empty()) {
+        return true;
+    }
+    FILE* file = std::fopen(path.c_str(), "ab");
+    if (file == nullptr) {
+        return false;
+    }
+    bool ok = std::fwrite(&bucket[0], sizeof(float), bucket.size(), file) == bucket.size();
+    ok = std::fclose(file) == 0 && ok;
+    std::vector<float>().swap(bucket);
+    return ok;
+}
+
+/**
+ * Returns the coordinate of the centroid of a triangle stored as 9 floats along one axis.
+ * @param tri The triangle corners.
+ * @param k The axis.
+ * @return The coordinate.
+ */
+static float centroid(const float* tri, int k) {
+    return (tri[k] + tri[3 + k] + tri[6 + k]) / 3.0f;
+}
+
+/**
+ * Reads the next block of triangles of a bucket file.
+ * @param file The open bucket file.
+ * @param block Vector to fill with up to BLOCK_TRIANGLES triangles.
+ * @return The number of triangles read, 0 at the end of the file.
+ */
+static size_t readBlock(FILE* file, std::vector<float>& block) {
+    block.resize(9 * BLOCK_TRIANGLES);
+    size_t numTris = std::fread(&block[0], sizeof(float), block.size(), file) / 9;
+    block.resize(9 * numTris);
+    return numTris;
+}
+
+/**
+ * Splits a bucket file in two at the median centroid along the longest axis of the centroid bounds.
+ * The file is streamed three times: for the bounds, for a histogram of the centroids, and to write the halves.
+ * If all centroids fall in the same histogram bin, the first half of the triangles goes to the first file.
+ * @param path Path of the bucket file.
+ * @param halfPaths Paths of the two files to write.
+ * @param halfTris Array of 2 ints to store the number of triangles written to each file.
+ * @return True on success.
+ */
+static bool splitBucket(const std::string& path, const std::string* halfPaths, int* halfTris) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::vector<float> block;
+    float minCentroid[3] = { 0.0f, 0.0f, 0.0f }, maxCentroid[3] = { 0.0f, 0.0f, 0.0f };
+    int numTris = 0;
+    for (size_t count = readBlock(file, block); count > 0; count = readBlock(file, block)) {
+        for (size_t t = 0; t < count; ++t, ++numTris) {
+            for (int k = 0; k < 3; ++k) {
+                float c = centroid(&block[9 * t], k);
+                minCentroid[k] = numTris == 0 ? c : std::min(minCentroid[k], c);
+                maxCentroid[k] = numTris == 0 ? c : std::max(maxCentroid[k], c);
+            }
+        }
+    }
+    int axis = 0;
+    for (int k = 1; k < 3; ++k) {
+        if (maxCentroid[k] - minCentroid[k] > maxCentroid[axis] - minCentroid[axis]) {
+            axis = k;
+        }
+    }
+    float range = maxCentroid[axis] - minCentroid[axis];
+    auto binOf = [&](const float* tri) {
+        int bin = range > 0.0f ? static_cast<int>((centroid(tri, axis) - minCentroid[axis]) / range * SPLIT_BINS) : 0;
+        return std::min(std::max(bin, 0), SPLIT_BINS - 1);
+    };
+
+    std::vector<int> bins(SPLIT_BINS, 0);
+    std::rewind(file);
+    for (size_t count = readBlock(file, block); count > 0; count = readBlock(file, block)) {
+        for (size_t t = 0; t < count; ++t) {
+            bins[binOf(&block[9 * t])]++;
+        }
+    }
+    // The first half takes the bins up to the boundary closest to the median
+    int splitBin = -1;
+    long long below = 0, left = 0;
+    for (int bin = 0; bin < SPLIT_BINS - 1; ++bin) {
+        below += bins[bin];
+        if (std::abs(2 * below - numTris) < std::abs(2 * left - numTris)) {
+            left = below;
+            splitBin = bin;
+        }
+    }
+    bool byPosition = left == 0 || left == numTris;
+
+    std::vector<float> halves[2];
+    halfTris[0] = halfTris[1] = 0;
+    bool ok = true;
+    for (int h = 0; h < 2; ++h) {
+        std::remove(halfPaths[h].c_str());
+    }
+    std::rewind(file);
+    for (size_t count = readBlock(file, block); count > 0 && ok; count = readBlock(file, block)) {
+        for (size_t t = 0; t < count && ok; ++t) {
+            const float* tri = &block[9 * t];
+            int h = byPosition ? (halfTris[0] < numTris / 2 ? 0 : 1) : (binOf(tri) > splitBin ? 1 : 0);
+            halves[h].insert(halves[h].end(), tri, tri + 9);
+            halfTris[h]++;
+            if (halves[h].size() >= 9 * BLOCK_TRIANGLES) {
+                ok = appendBucket(halfPaths[h], halves[h]);
+            }
+        }
+    }
+    std::fclose(file);
+    for (int h = 0; h < 2; ++h) {
+        ok = appendBucket(halfPaths[h], halves[h]) && ok;
+    }
+    return ok && halfTris[0] + halfTris[1] == numTris;
+}
+
+/**
+ * Reads the size and modification time of a file.
+ * @param name Path of the file.
+ * @param stamp Array of 2 long longs to store the size in bytes and the modification time.
+ * @return True on success.
+ */
+static bool getSourceStamp(const char* name, long long* stamp) {
+    FileStatus status;
+    if (statFile(name, &status) != 0) {
+        return false;
+    }
+    stamp[0] = static_cast<long long>(status.st_size);
+    stamp[1] = static_cast<long long>(status.st_mtime);
+    return true;
+}
+
+/**
+ * Constructor for OutOfCoreMesh.
+ * @param directory Existing directory holding the chunk files.
+ * @param memoryBudget Maximum number of bytes of chunk data kept in memory.
+ */
+OutOfCoreMesh::OutOfCoreMesh(const char* directory, size_t memoryBudget)
+    : directory(directory), memoryBudget(memoryBudget), numVertices(0), orientation(1.0f), cachedBytes(0) {
+}
+
+/**
+ * Destructor for OutOfCoreMesh. Releases the cached chunks.
+ */
+OutOfCoreMesh::~OutOfCoreMesh() {
+    clearCache();
+}
+
+/**
+ * Partitions an OFF file into chunks.
+ * Pass 1 copies the vertices to a binary file. Pass 2 streams the triangles, reads their
+ * corners back through a paged cache and appends them to the bucket of the grid cell
+ * containing their centroid. Pass 3 splits every bucket holding more than trianglesPerChunk
+ * triangles in two at the median centroid along its longest axis, like the nodes of a kd-tree,
+ * until all of them fit, and builds and stores the BVH of every bucket. Buckets are streamed
+ * while they are split, so only buckets that fit are ever loaded whole.
+ * @param name Path of the OFF file.
+ * @param trianglesPerChunk Maximum number of triangles per chunk; lowered so that a chunk fits in the memory budget.
+ * @return True on success.
+ */
+bool OutOfCoreMesh::build(const char* name, int trianglesPerChunk) {
+    clearCache();
+    chunks.clear();
+    trianglesPerChunk = static_cast<int>(std::min<size_t>(std::max(1, trianglesPerChunk),
+        std::max<size_t>(1, memoryBudget / CHUNK_BYTES_PER_TRIANGLE)));
+
+    long long stamp[2];
+    if (!getSourceStamp(name, stamp)) {
+        return false;
+    }
+    FILE* fPtr = std::fopen(name, "r");
+    if (fPtr == nullptr) {
+        return false;
+    }
+    char str[334];
+    int nVerts, nTris, n;
+    if (std::fscanf(fPtr, "%333s", str) != 1 || std::fscanf(fPtr, "%d %d %d", &nVerts, &nTris, &n) != 3) {
+        std::fclose(fPtr);
+        return false;
+    }
+
+    // Pass 1: vertices
+    std::string vertexPath = filePath("vertices.tmp");
+    FILE* vertexFile = std::fopen(vertexPath.c_str(), "w+b");
+    if (vertexFile == nullptr) {
+        std::fclose(fPtr);
+        return false;
+    }
+    float minCoords[3] = { 0.0f, 0.0f, 0.0f }, maxCoords[3] = { 0.0f, 0.0f, 0.0f };
+    std::vector<float> block;
+    bool ok = true;
+    for (int i = 0; i < nVerts && ok; ++i) {
+        float c[3];
+        ok = std::fscanf(fPtr, "%f %f %f", &c[0], &c[1], &c[2]) == 3;
+        for (int k = 0; k < 3; ++k) {
+            minCoords[k] = (i == 0) ? c[k] : std::min(minCoords[k], c[k]);
+            maxCoords[k] = (i == 0) ? c[k] : std::max(maxCoords[k], c[k]);
+        }
+        block.insert(block.end(), c, c + 3);
+        if (block.size() == 3 * static_cast<size_t>(PAGE_SIZE) || i == nVerts - 1) {
+            ok = ok && std::fwrite(&block[0], sizeof(float), block.size(), vertexFile) == block.size();
+            block.clear();
+        }
+    }
+    std::fflush(vertexFile);
+    numVertices = nVerts;
+
+    // Pass 2: triangles into grid buckets; the grid is only a first cut, pass 3 splits what it leaves too large
+    int cells = std::max(1, static_cast<int>(std::ceil(std::cbrt(static_cast<double>(nTris) / trianglesPerChunk))));
+    cells = std::min(cells, MAX_GRID_CELLS);
+    int numCells = cells * cells * cells;
+    std::vector<int> bucketTris(numCells, 0);
+    for (int c = 0; c < numCells; ++c) {
+        std::remove(filePath(chunkName(c, "tmp")).c_str());
+    }
+
+    std::vector<std::vector<float> > buckets(numCells);
+    size_t bucketBytes = 0;
+    VertexPages pages(vertexFile, nVerts, memoryBudget / 2);
+    double signedVolume = 0.0;
+    int count, a, b, c;
+    while (ok && std::fscanf(fPtr, "%d", &count) == 1) {
+        float tri[9];
+        ok = std::fscanf(fPtr, "%d %d %d", &a, &b, &c) == 3 && pages.get(a, tri) && pages.get(b, tri + 3) && pages.get(c, tri + 6);
+        if (!ok) {
+            break;
+        }
+        signedVolume += (tri[0] * (tri[4] * tri[8] - tri[5] * tri[7])
+            - tri[1] * (tri[3] * tri[8] - tri[5] * tri[6])
+            + tri[2] * (tri[3] * tri[7] - tri[4] * tri[6])) / 6.0;
+
+        int cell[3];
+        for (int k = 0; k < 3; ++k) {
+            float range = maxCoords[k] - minCoords[k];
+            cell[k] = range > 0.0f ? static_cast<int>((centroid(tri, k) - minCoords[k]) / range * cells) : 0;
+            cell[k] = std::min(std::max(cell[k], 0), cells - 1);
+        }
+        int bucket = (cell[2] * cells + cell[1]) * cells + cell[0];
+        buckets[bucket].insert(buckets[bucket].end(), tri, tri + 9);
+        bucketTris[bucket]++;
+        bucketBytes += sizeof(tri);
+
+        if (bucketBytes > memoryBudget / 2) {
+            for (int i = 0; i < numCells; ++i) {
+                ok = appendBucket(filePath(chunkName(i, "tmp")), buckets[i]) && ok;
+            }
+            bucketBytes = 0;
+        }
+    }
+    for (int i = 0; i < numCells; ++i) {
+        ok = appendBucket(filePath(chunkName(i, "tmp")), buckets[i]) && ok;
+    }
+    std::fclose(fPtr);
+    std::fclose(vertexFile);
+    std::remove(vertexPath.c_str());
+    orientation = signedVolume < 0.0 ? -1.0f : 1.0f;
+
+    // Pass 3: split the buckets over the limit, then one BVH per bucket
+    struct Bucket {
+        int file;
+        int numTris;
+    };
+    std::vector<Bucket> pending;
+    for (int i = numCells - 1; i >= 0; --i) {
+        Bucket bucket = { i, bucketTris[i] };
+        if (bucket.numTris > 0) {
+            pending.push_back(bucket);
+        }
+    }
+    int nextFile = numCells;
+    while (ok && !pending.empty()) {
+        Bucket bucket = pending.back();
+        pending.pop_back();
+        std::string bucketPath = filePath(chunkName(bucket.file, "tmp"));
+        if (bucket.numTris <= trianglesPerChunk) {
+            ok = writeChunk(bucketPath, bucket.numTris);
+        }
+        else {
+            std::string halfPaths[2] = { filePath(chunkName(nextFile, "tmp")), filePath(chunkName(nextFile + 1, "tmp")) };
+            int halfTris[2];
+            ok = splitBucket(bucketPath, halfPaths, halfTris);
+            Bucket halves[2] = { { nextFile, halfTris[0] }, { nextFile + 1, halfTris[1] } };
+            pending.push_back(halves[1]);
+            pending.push_back(halves[0]);
+            nextFile += 2;
+        }
+        std::remove(bucketPath.c_str());
+    }
+    for (size_t i = 0; i < pending.size(); ++i) {
+        std::remove(filePath(chunkName(pending[i].file, "tmp")).c_str());
+    }
+
+    // Index, stamped with the source file so that open can tell if it is stale
+    FILE* indexFile = std::fopen(filePath("index.bin").c_str(), "wb");
+    if (indexFile == nullptr) {
+        return false;
+    }
+    std::string source(name);
+    int header[4] = { INDEX_MAGIC, numVertices, static_cast<int>(chunks.size()), static_cast<int>(source.size()) };
+    ok = ok && std::fwrite(header, sizeof(int), 4, indexFile) == 4;
+    ok = ok && std::fwrite(source.data(), 1, source.size(), indexFile) == source.size();
+    ok = ok && std::fwrite(stamp, sizeof(long long), 2, indexFile) == 2;
+    ok = ok && std::fwrite(&orientation, sizeof(float), 1, indexFile) == 1;
+    ok = ok && (chunks.empty() || std::fwrite(&chunks[0], sizeof(ChunkInfo), chunks.size(), indexFile) == chunks.size());
+    ok = std::fclose(indexFile) == 0 && ok;
+    if (!ok) {
+        // Never leave a partial index that open would accept
+        std::remove(filePath("index.bin").c_str());
+    }
+
+    loaded.assign(chunks.size(), nullptr);
+    lruPos.assign(chunks.size(), lru.end());
+    return ok;
+}
+
+/**
+ * Opens chunks previously written by build for the same file.
+ * The index is rejected if the file has changed size or modification time since,
+ * or if a chunk would not fit in the memory budget.
+ * @param name Path of the OFF file the chunks must have been built from.
+ * @return True on success.
+ */
+bool OutOfCoreMesh::open(const char* name) {
+    clearCache();
+    chunks.clear();
+
+    long long stamp[2];
+    if (!getSourceStamp(name, stamp)) {
+        return false;
+    }
+    FILE* indexFile = std::fopen(filePath("index.bin").c_str(), "rb");
+    if (indexFile == nullptr) {
+        return false;
+    }
+    int header[4];
+    long long indexStamp[2];
+    bool ok = std::fread(header, sizeof(int), 4, indexFile) == 4 && header[0] == INDEX_MAGIC && header[2] >= 0 && header[3] >= 0;
+    std::string source(ok ? header[3] : 0, '\0');
+    ok = ok && (source.empty() || std::fread(&source[0], 1, source.size(), indexFile) == source.size());
+    ok = ok && std::fread(indexStamp, sizeof(long long), 2, indexFile) == 2;
+    ok = ok && source == name && indexStamp[0] == stamp[0] && indexStamp[1] == stamp[1];
+    ok = ok && std::fread(&orientation, sizeof(float), 1, indexFile) == 1;
+    if (ok) {
+        numVertices = header[1];
+        chunks.resize(header[2]);
+        ok = chunks.empty() || std::fread(&chunks[0], sizeof(ChunkInfo), chunks.size(), indexFile) == chunks.size();
+    }
+    std::fclose(indexFile);
+    for (size_t c = 0; c < chunks.size() && ok; ++c) {
+        ok = chunks[c].numTris * CHUNK_BYTES_PER_TRIANGLE <= memoryBudget;
+    }
+    if (!ok) {
+        chunks.clear();
+        return false;
+    }
+
+    loaded.assign(chunks.size(), nullptr);
+    lruPos.assign(chunks.size(), lru.end());
+    return true;
+}
+
+/**
+ * Builds the BVH of a bucket file and stores it as the next chunk.
+ * @param bucketPath Path of the bucket file.
+ * @param numTris Number of triangles in the bucket.
+ * @return True on success.
+ */
+bool OutOfCoreMesh::writeChunk(const std::string& bucketPath, int numTris) {
+    std::vector<float> soup(9 * static_cast<size_t>(numTris));
+    FILE* bucketFile = std::fopen(bucketPath.c_str(), "rb");
+    bool ok = bucketFile != nullptr && std::fread(&soup[0], sizeof(float), soup.size(), bucketFile) == soup.size();
+    if (bucketFile != nullptr) {
+        std::fclose(bucketFile);
+    }
+    if (!ok) {
+        return false;
+    }
+
+    Bvh bvh;
+    bvh.build(soup);
+    ChunkInfo info = { { 0, 0, 0, 0, 0, 0 }, numTris, 0.0 };
+    std::copy(bvh.getBounds(), bvh.getBounds() + 6, info.bounds);
+    for (int t = 0; t < numTris; ++t) {
+        double cross[3];
+        triangleCross(&soup[9 * t], cross);
+        info.area += 0.5 * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+    }
+
+    FILE* chunkFile = std::fopen(filePath(chunkName(static_cast<int>(chunks.size()), "bvh")).c_str(), "wb");
+    ok = chunkFile != nullptr && bvh.write(chunkFile);
+    if (chunkFile != nullptr) {
+        ok = std::fclose(chunkFile) == 0 && ok;
+    }
+    chunks.push_back(info);
+    return ok;
+}
+
+/**
+ * Checks if a point is inside the mesh using ray casting.
+ * The ray has the same fixed direction as in MedialAxisTransformer::isPointInsideMesh; only the
+ * chunks whose bounds it crosses are loaded and traversed.
+ * @param point Coordinates of the point.
+ * @return True if the point is inside the mesh, false otherwise.
+ */
+bool OutOfCoreMesh::isPointInside(const float* point) {
+    int intersections = 0;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        if (chunks[c].numTris == 0 || !rayHitsBox(point, CROSSING_DIRECTION, chunks[c].bounds)) {
+            continue;
+        }
+        const Bvh* bvh = getChunk(static_cast<int>(c));
+        if (bvh != nullptr) {
+            intersections += bvh->countCrossings(point, CROSSING_DIRECTION);
+        }
+    }
+    return (intersections % 2) == 1; // Point is inside if intersections count is odd
+}
+
+/**
+ * Samples points on the surface of one chunk, with probability proportional to triangle area.
+ * Sample i only depends on the seed and its index firstIdx + i, like the samples of an in-memory mesh.
+ * @param chunk Index of the chunk.
+ * @param count Number of points to sample.
+ * @param firstIdx Index given to the first sampled vertex; the others follow consecutively.
+ * @param seed Seed of the random numbers.
+ * @return A vector of sampled vertices carrying outward normals.
+ */
+std::vector<Vertex*> OutOfCoreMesh::sampleChunk(int chunk, int count, int firstIdx, unsigned int seed) {
+    std::vector<Vertex*> sampledPoints;
+    const Bvh* bvh = count > 0 ? getChunk(chunk) : nullptr;
+    if (bvh == nullptr) {
+        return sampledPoints;
+    }
+
+    const std::vector<float>& tris = bvh->getTriangles();
+    size_t numTris = tris.size() / 9;
+    std::vector<double> accumulatedArea(numTris);
+    double total = 0.0;
+    for (size_t t = 0; t < numTris; ++t) {
+        double cross[3];
+        triangleCross(&tris[9 * t], cross);
+        total += 0.5 * std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        accumulatedArea[t] = total;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        double r = sampleRandom(seed, firstIdx + i, 0) * total;
+        size_t t = std::lower_bound(accumulatedArea.begin(), accumulatedArea.end(), r) - accumulatedArea.begin();
+        const float* tri = &tris[9 * std::min(t, numTris - 1)];
+
+        // Barycentric coordinates to sample a point inside the selected triangle
+        float u = sampleRandom(seed, firstIdx + i, 1);
+        float v = sampleRandom(seed, firstIdx + i, 2);
+        if (u + v > 1.0f) {
+            u = 1.0f - u;
+            v = 1.0f - v;
+        }
+        float w = 1.0f - u - v;
+        float* coords = new float[3];
+        float* normals = new float[3];
+        double cross[3];
+        triangleCross(tri, cross);
+        double length = std::sqrt(cross[0] * cross[0] + cross[1] * cross[1] + cross[2] * cross[2]);
+        for (int k = 0; k < 3; ++k) {
+            coords[k] = u * tri[k] + v * tri[3 + k] + w * tri[6 + k];
+            normals[k] = length > 0.0 ? static_cast<float>(orientation * cross[k] / length) : 0.0f;
+        }
+        Vertex* sampledVertex = new Vertex(firstIdx + i, coords);
+        sampledVertex->normals = normals;
+        sampledPoints.push_back(sampledVertex);
+    }
+    return sampledPoints;
+}
+
+/**
+ * Returns the number of chunks.
+ * @return The number of chunks.
+ */
+int OutOfCoreMesh::getNumChunks() const {
+    return static_cast<int>(chunks.size());
+}
+
+/**
+ * Returns the number of vertices of the mesh.
+ * @return The number of vertices.
+ */
+int OutOfCoreMesh::getNumVertices() const {
+    return numVertices;
+}
+
+/**
+ * Returns the surface area of one chunk.
+ * @param chunk Index of the chunk.
+ * @return The area.
+ */
+double OutOfCoreMesh::getChunkArea(int chunk) const {
+    return chunks[chunk].area;
+}
+
+/**
+ * Returns the surface area of the mesh.
+ * @return The area.
+ */
+double OutOfCoreMesh::getTotalArea() const {
+    double total = 0.0;
+    for (size_t c = 0; c < chunks.size(); ++c) {
+        total += chunks[c].area;
+    }
+    return total;
+}
+
+/**
+ * Returns a chunk, loading it and evicting the least recently used ones if needed.
+ * build and open only accept chunks that fit in the budget on their own, so the cache never exceeds it.
+ * @param chunk Index of the chunk.
+ * @return Pointer to the chunk BVH, or nullptr if it could not be read or does not fit in the budget.
+ */
+const Bvh* OutOfCoreMesh::getChunk(int chunk) {
+    if (loaded[chunk] != nullptr) {
+        lru.splice(lru.begin(), lru, lruPos[chunk]);
+        return loaded[chunk];
+    }
+
+    FILE* file = std::fopen(filePath(chunkName(chunk, "bvh")).c_str(), "rb");
+    if (file == nullptr) {
+        return nullptr;
+    }
+    Bvh* bvh = new Bvh();
+    bool ok = bvh->read(file);
+    std::fclose(file);
+    if (!ok) {
+        delete bvh;
+        return nullptr;
+    }
+
+    size_t bytes = bvh->memoryUsage();
+    if (bytes > memoryBudget) {
+        delete bvh;
+        return nullptr;
+    }
+    while (!lru.empty() && cachedBytes + bytes > memoryBudget) {
+        int victim = lru.back();
+        lru.pop_back();
+        cachedBytes -= loaded[victim]->memoryUsage();
+        delete loaded[victim];
+        loaded[victim] = nullptr;
+    }
+    lru.push_front(chunk);
+    lruPos[chunk] = lru.begin();
+    loaded[chunk] = bvh;
+    cachedBytes += bytes;
+    return bvh;
+}
+
+/**
+ * Releases all cached chunks.
+ */
+void OutOfCoreMesh::clearCache() {
+    for (size_t c = 0; c < loaded.size(); ++c) {
+        delete loaded[c];
+        loaded[c] = nullptr;
+    }
+    lru.clear();
+    cachedBytes = 0;
+}
+
+/**
+ * Returns the path of a file in the chunk directory.
+ * @param name File name.
+ * @return The path.
+ */
+std::string OutOfCoreMesh::filePath(const std::string& name) const {
+    return directory + "/" + name;
+}
+
+/**
+ * Returns the file name of a chunk.
+ * @param chunk Index of the chunk.
+ * @param extension File extension.
+ * @return The file name.
+ */
+std::string OutOfCoreMesh::chunkName(int chunk, const char* extension) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "chunk_%06d.%s", chunk, extension);
+    return name;
+}
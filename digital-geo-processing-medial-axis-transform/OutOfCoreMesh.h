@@ -0,0 +1,145 @@
+#pragma once
+
+#include "Mesh.h"
+#include "Bvh.h"
+#include <list>
+#include <string>
+#include <vector>
+
+/**
+ * Class for meshes that do not fit in memory.
+ * The mesh is partitioned on a uniform grid, whose crowded cells are split like the nodes of a kd-tree,
+ * into chunks stored on disk, each with its own BVH and no larger than the memory budget.
+ * Chunks are loaded on demand through an LRU cache whose size is bounded by that budget.
+ */
+class OutOfCoreMesh {
+public:
+    /**
+     * Constructor for OutOfCoreMesh.
+     * @param directory Existing directory holding the chunk files.
+     * @param memoryBudget Maximum number of bytes of chunk data kept in memory.
+     */
+    OutOfCoreMesh(const char* directory, size_t memoryBudget);
+
+    /**
+     * Destructor for OutOfCoreMesh. Releases the cached chunks.
+     */
+    ~OutOfCoreMesh();
+
+    /**
+     * Partitions an OFF file into chunks. The file is streamed; vertices are read back
+     * through a paged cache, so memory use stays within the budget for any mesh size.
+     * @param name Path of the OFF file.
+     * @param trianglesPerChunk Maximum number of triangles per chunk; lowered so that a chunk fits in the memory budget.
+     * @return True on success.
+     */
+    bool build(const char* name, int trianglesPerChunk = 262144);
+
+    /**
+     * Opens chunks previously written by build for the same file.
+     * The index is rejected if the file has changed size or modification time since,
+     * or if a chunk would not fit in the memory budget.
+     * @param name Path of the OFF file the chunks must have been built from.
+     * @return True on success.
+     */
+    bool open(const char* name);
+
+    /**
+     * Checks if a point is inside the mesh using ray casting.
+     * Only the chunks whose bounds the ray crosses are loaded.
+     * @param point Coordinates of the point.
+     * @return True if the point is inside the mesh, false otherwise.
+     */
+    bool isPointInside(const float* point);
+
+    /**
+     * Samples points on the surface of one chunk, with probability proportional to triangle area.
+     * Sample i only depends on the seed and its index firstIdx + i, like the samples of an in-memory mesh.
+     * @param chunk Index of the chunk.
+     * @param count Number of points to sample.
+     * @param firstIdx Index given to the first sampled vertex; the others follow consecutively.
+     * @param seed Seed of the random numbers.
+     * @return A vector of sampled vertices carrying outward normals.
+     */
+    std::vector<Vertex*> sampleChunk(int chunk, int count, int firstIdx, unsigned int seed);
+
+    /**
+     * Returns the number of chunks.
+     * @return The number of chunks.
+     */
+    int getNumChunks() const;
+
+    /**
+     * Returns the number of vertices of the mesh.
+     * @return The number of vertices.
+     */
+    int getNumVertices() const;
+
+    /**
+     * Returns the surface area of one chunk.
+     * @param chunk Index of the chunk.
+     * @return The area.
+     */
+    double getChunkArea(int chunk) const;
+
+    /**
+     * Returns the surface area of the mesh.
+     * @return The area.
+     */
+    double getTotalArea() const;
+
+private:
+    /**
+     * Per-chunk summary kept in memory.
+     */
+    struct ChunkInfo {
+        float bounds[6]; ///< Min xyz followed by max xyz.
+        int numTris; ///< Number of triangles.
+        double area; ///< Surface area.
+    };
+
+    std::string directory; ///< Directory holding the chunk files.
+    size_t memoryBudget; ///< Maximum number of bytes of cached chunks.
+    std::vector<ChunkInfo> chunks; ///< Chunk summaries.
+    int numVertices; ///< Number of vertices of the mesh.
+    float orientation; ///< 1 if the triangles are wound counterclockwise seen from outside, -1 otherwise.
+    std::vector<Bvh*> loaded; ///< Cached chunks; nullptr if not in memory.
+    std::list<int> lru; ///< Cached chunk indices, most recently used first.
+    std::vector<std::list<int>::iterator> lruPos; ///< Position of each cached chunk in lru.
+    size_t cachedBytes; ///< Bytes held by the cached chunks.
+
+    /**
+     * Returns a chunk, loading it and evicting the least recently used ones if needed.
+     * @param chunk Index of the chunk.
+     * @return Pointer to the chunk BVH, or nullptr if it could not be read or does not fit in the budget.
+     */
+    const Bvh* getChunk(int chunk);
+
+    /**
+     * Builds the BVH of a bucket file and stores it as the next chunk.
+     * @param bucketPath Path of the bucket file.
+     * @param numTris Number of triangles in the bucket.
+     * @return True on success.
+     */
+    bool writeChunk(const std::string& bucketPath, int numTris);
+
+    /**
+     * Releases all cached chunks.
+     */
+    void clearCache();
+
+    /**
+     * Returns the path of a file in the chunk directory.
+     * @param name File name.
+     * @return The path.
+     */
+    std::string filePath(const std::string& name) const;
+
+    /**
+     * Returns the file name of a chunk.
+     * @param chunk Index of the chunk.
+     * @param extension File extension.
+     * @return The file name.
+     */
+    std::string chunkName(int chunk, const char* extension) const;
+};
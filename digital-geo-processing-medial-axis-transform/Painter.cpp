@@ -104,6 +104,80 @@ SoSeparator* Painter::getMedialAxisLinesSep(const std::vector<Vertex*>& centers)
 }
 
 
+/**
+ * Creates a separator node for the outline of a polygon, drawn in the z = 0 plane.
+ * @param polygon Pointer to the polygon object.
+ * @return A separator node containing the outline.
+ */
+SoSeparator* Painter::getPolygonSep(Polygon2D* polygon) {
+	SoSeparator* res = new SoSeparator();
+	SoMaterial* mat = new SoMaterial();
+	mat->diffuseColor.setValue(0, 1, 0); // Same green as the mesh
+	res->addChild(mat);
+	SoCoordinate3* coords = new SoCoordinate3();
+	for (size_t i = 0; i < polygon->coords.size() / 2; ++i) {
+		coords->point.set1Value(i, polygon->coords[2 * i], polygon->coords[2 * i + 1], 0.0f);
+	}
+	SoIndexedLineSet* lineSet = new SoIndexedLineSet();
+	for (size_t i = 0; i < polygon->segments.size() / 2; ++i) {
+		lineSet->coordIndex.set1Value(i * 3, polygon->segments[2 * i]);
+		lineSet->coordIndex.set1Value(i * 3 + 1, polygon->segments[2 * i + 1]);
+		lineSet->coordIndex.set1Value(i * 3 + 2, -1);
+	}
+	res->addChild(coords);
+	res->addChild(lineSet);
+	return res;
+}
+
+/**
+ * Fills a coordinate node from flat 2D coordinates, placing the points at z = 0.
+ * @param points Flat vector of coordinates, 2 per point.
+ * @return The coordinate node.
+ */
+static SoCoordinate3* makeCoordinates(const std::vector<float>& points) {
+	SoCoordinate3* coords = new SoCoordinate3();
+	for (size_t i = 0; i < points.size() / 2; ++i) {
+		coords->point.set1Value(i, points[2 * i], points[2 * i + 1], 0.0f);
+	}
+	return coords;
+}
+
+/**
+ * Creates a separator node for 2D sampled points given as flat coordinates, drawn in the z = 0 plane.
+ * @param sampledPoints Flat vector of coordinates, 2 per point.
+ * @return A separator node containing the sampled points.
+ */
+SoSeparator* Painter::getSampledPointsSep(const std::vector<float>& sampledPoints) {
+	SoSeparator* res = new SoSeparator();
+	SoMaterial* mat = new SoMaterial();
+	mat->diffuseColor.setValue(1, 0, 0); // Red color for sampled points
+	res->addChild(mat);
+	res->addChild(makeCoordinates(sampledPoints));
+	res->addChild(new SoPointSet());
+	return res;
+}
+
+/**
+ * Creates a separator node for the medial axis lines given as flat 2D center coordinates, drawn in the z = 0 plane.
+ * @param centers Flat vector of ball centers, 2 per center.
+ * @return A separator node containing the medial axis lines.
+ */
+SoSeparator* Painter::getMedialAxisLinesSep(const std::vector<float>& centers) {
+	SoSeparator* res = new SoSeparator();
+	SoMaterial* mat = new SoMaterial();
+	mat->diffuseColor.setValue(1, 1, 0); // Yellow color for medial axis lines
+	res->addChild(mat);
+	SoIndexedLineSet* lineSet = new SoIndexedLineSet();
+	for (size_t i = 0; i + 1 < centers.size() / 2; ++i) {
+		lineSet->coordIndex.set1Value(i * 3, i);
+		lineSet->coordIndex.set1Value(i * 3 + 1, i + 1);
+		lineSet->coordIndex.set1Value(i * 3 + 2, -1);
+	}
+	res->addChild(makeCoordinates(centers));
+	res->addChild(lineSet);
+	return res;
+}
+
 /* stuff below are from my old projects; should run fine and be useful in your development
 
 if (drawThickEdges) //draw thick edges (may be useful in geodesic path drawing)
@@ -11,6 +11,7 @@
 #include <Inventor/nodes/SoIndexedLineSet.h>
 
 #include "Mesh.h"
+#include "Polygon2D.h"
 
 /**
  * Class for rendering different elements of the mesh and medial axis.
@@ -45,4 +46,25 @@ public:
      * @return A separator node containing the medial axis lines.
      */
     SoSeparator* getMedialAxisLinesSep(const std::vector<Vertex*>& centers);
+
+    /**
+     * Returns a separator node for the outline of a polygon, drawn in the z = 0 plane.
+     * @param polygon Pointer to the polygon object.
+     * @return A separator node containing the outline.
+     */
+    SoSeparator* getPolygonSep(Polygon2D* polygon);
+
+    /**
+     * Returns a separator node for 2D sampled points given as flat coordinates, drawn in the z = 0 plane.
+     * @param sampledPoints Flat vector of coordinates, 2 per point.
+     * @return A separator node containing the sampled points.
+     */
+    SoSeparator* getSampledPointsSep(const std::vector<float>& sampledPoints);
+
+    /**
+     * Returns a separator node for the medial axis lines given as flat 2D center coordinates, drawn in the z = 0 plane.
+     * @param centers Flat vector of ball centers, 2 per center.
+     * @return A separator node containing the medial axis lines.
+     */
+    SoSeparator* getMedialAxisLinesSep(const std::vector<float>& centers);
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+/**
+ * Runs a function on every index in [0, count), splitting the range into contiguous blocks over all hardware threads.
+ * @param count Number of indices.
+ * @param function Callable taking a size_t index.
+ */
+template <typename Function>
+void parallelFor(size_t count, const Function& function) {
+    size_t numThreads = std::max(1u, std::thread::hardware_concurrency());
+    numThreads = std::min(numThreads, std::max(static_cast<size_t>(1), count));
+    size_t block = (count + numThreads - 1) / numThreads;
+
+    std::vector<std::thread> threads;
+    for (size_t t = 1; t < numThreads; ++t) {
+        size_t begin = t * block;
+        size_t end = std::min(count, begin + block);
+        threads.push_back(std::thread([&function, begin, end]() {
+            for (size_t i = begin; i < end; ++i) {
+                function(i);
+            }
+        }));
+    }
+    for (size_t i = 0; i < std::min(count, block); ++i) {
+        function(i);
+    }
+    for (size_t t = 0; t < threads.size(); ++t) {
+        threads[t].join();
+    }
+}
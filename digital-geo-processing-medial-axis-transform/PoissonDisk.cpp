@@ -0,0 +1,282 @@
+#include "PoissonDisk.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <unordered_map>
+
+/**
+ * Packs the coordinates of a grid cell into a hash key, 21 bits per axis.
+ * @param x Cell coordinate along x.
+ * @param y Cell coordinate along y.
+ * @param z Cell coordinate along z.
+ * @return The key.
+ */
+static unsigned long long cellKey(int x, int y, int z) {
+    const unsigned long long MASK = (1ULL << 21) - 1;
+    return (static_cast<unsigned long long>(x) & MASK) | ((static_cast<unsigned long long>(y) & MASK) << 21)
+        | ((static_cast<unsigned long long>(z) & MASK) << 42);
+}
+
+/**
+ * Accepted points hashed by cell. Each cell holds the candidate indices accepted in it.
+ */
+typedef std::unordered_map<unsigned long long, std::vector<size_t> > CellHash;
+
+/**
+ * Checks if a point is at least the radius away from every point of the 27 cells around its cell.
+ * @param hash Accepted points.
+ * @param candidates Flat vector of xyz candidate coordinates.
+ * @param cell Cell coordinates of the point.
+ * @param point Coordinates of the point.
+ * @param radiusSquared Squared minimum distance.
+ * @return True if no accepted point is too close.
+ */
+static bool isFarFromAll(const CellHash& hash, const std::vector<float>& candidates, const int* cell, const float* point,
+    float radiusSquared) {
+    for (int dz = -1; dz <= 1; ++dz) {
+        for (int dy = -1; dy <= 1; ++dy) {
+            for (int dx = -1; dx <= 1; ++dx) {
+                CellHash::const_iterator found = hash.find(cellKey(cell[0] + dx, cell[1] + dy, cell[2] + dz));
+                if (found == hash.end()) {
+                    continue;
+                }
+                for (size_t i = 0; i < found->second.size(); ++i) {
+                    const float* other = &candidates[3 * found->second[i]];
+                    float d[3] = { point[0] - other[0], point[1] - other[1], point[2] - other[2] };
+                    if (d[0] * d[0] + d[1] * d[1] + d[2] * d[2] < radiusSquared) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * Selects a Poisson-disk subset of candidate points: no two selected points are closer than the radius.
+ * Candidates are hashed into cells as wide as the radius and grouped into patches of cells. Patches are
+ * processed in 8 rounds by the parity of their coordinates; within a round no two patches are adjacent,
+ * so they run in parallel, and each accepts its candidates in input order against the points already
+ * accepted around it. The result only depends on the input, not on the number of threads.
+ * @param candidates Flat vector of xyz candidate coordinates, in random order for an unbiased selection.
+ * @param radius Minimum distance between selected points.
+ * @return Indices of the selected candidates in increasing order.
+ */
+std::vector<size_t> selectPoissonDisk(const std::vector<float>& candidates, float radius) {
+    size_t numCandidates = candidates.size() / 3;
+    std::vector<size_t> selected;
+    if (numCandidates == 0) {
+        return selected;
+    }
+    if (!(radius > 0.0f)) {
+        for (size_t i = 0; i < numCandidates; ++i) {
+            selected.push_back(i);
+        }
+        return selected;
+    }
+
+    float minCorner[3], maxCorner[3];
+    for (int k = 0; k < 3; ++k) {
+        minCorner[k] = maxCorner[k] = candidates[k];
+    }
+    for (size_t i = 1; i < numCandidates; ++i) {
+        for (int k = 0; k < 3; ++k) {
+            minCorner[k] = std::min(minCorner[k], candidates[3 * i + k]);
+            maxCorner[k] = std::max(maxCorner[k], candidates[3 * i + k]);
+        }
+    }
+
+    // Cells no smaller than the radius, so conflicts are within the 27 neighbouring cells; the keys hold 2^21 cells per axis
+    float cellSize = radius;
+    int gridCells = 1;
+    for (int k = 0; k < 3; ++k) {
+        cellSize = std::max(cellSize, (maxCorner[k] - minCorner[k]) / ((1 << 21) - 2));
+    }
+    for (int k = 0; k < 3; ++k) {
+        gridCells = std::max(gridCells, static_cast<int>((maxCorner[k] - minCorner[k]) / cellSize) + 1);
+    }
+
+    // Patches of several cells, about 16 per axis, so a round has enough patches to share between threads
+    int patchCells = std::max(1, (gridCells + 15) / 16);
+    int patchesPerAxis = (gridCells + patchCells - 1) / patchCells;
+
+    std::vector<int> cells(3 * numCandidates);
+    std::vector<int> keys(numCandidates);
+    int patchesPerRound = patchesPerAxis * patchesPerAxis * patchesPerAxis;
+    for (size_t i = 0; i < numCandidates; ++i) {
+        int patch[3];
+        for (int k = 0; k < 3; ++k) {
+            cells[3 * i + k] = std::min(gridCells - 1, static_cast<int>((candidates[3 * i + k] - minCorner[k]) / cellSize));
+            patch[k] = cells[3 * i + k] / patchCells;
+        }
+        int parity = (patch[0] & 1) | ((patch[1] & 1) << 1) | ((patch[2] & 1) << 2);
+        keys[i] = parity * patchesPerRound + (patch[2] * patchesPerAxis + patch[1]) * patchesPerAxis + patch[0];
+    }
+
+    // Counting sort of the candidates by round and patch, keeping the input order within a patch
+    int numKeys = 8 * patchesPerRound;
+    std::vector<size_t> keyStart(numKeys + 1, 0);
+    for (size_t i = 0; i < numCandidates; ++i) {
+        ++keyStart[keys[i] + 1];
+    }
+    for (int key = 0; key < numKeys; ++key) {
+        keyStart[key + 1] += keyStart[key];
+    }
+    std::vector<size_t> order(numCandidates);
+    std::vector<size_t> next(keyStart.begin(), keyStart.end() - 1);
+    for (size_t i = 0; i < numCandidates; ++i) {
+        order[next[keys[i]]++] = i;
+    }
+
+    CellHash accepted;
+    std::vector<char> isSelected(numCandidates, 0);
+    float radiusSquared = radius * radius;
+    for (int round = 0; round < 8; ++round) {
+        std::vector<int> patches;
+        for (int key = round * patchesPerRound; key < (round + 1) * patchesPerRound; ++key) {
+            if (keyStart[key + 1] > keyStart[key]) {
+                patches.push_back(key);
+            }
+        }
+
+        // Same-parity patches are a patch apart, so each only reads the earlier rounds and its own points
+        std::vector<std::vector<size_t> > patchSelected(patches.size());
+        parallelFor(patches.size(), [&](size_t p) {
+            CellHash local;
+            for (size_t o = keyStart[patches[p]]; o < keyStart[patches[p] + 1]; ++o) {
+                size_t i = order[o];
+                const int* cell = &cells[3 * i];
+                const float* point = &candidates[3 * i];
+                if (isFarFromAll(accepted, candidates, cell, point, radiusSquared)
+                    && isFarFromAll(local, candidates, cell, point, radiusSquared)) {
+                    local[cellKey(cell[0], cell[1], cell[2])].push_back(i);
+                    patchSelected[p].push_back(i);
+                }
+            }
+        });
+
+        for (size_t p = 0; p < patchSelected.size(); ++p) {
+            for (size_t s = 0; s < patchSelected[p].size(); ++s) {
+                size_t i = patchSelected[p][s];
+                accepted[cellKey(cells[3 * i], cells[3 * i + 1], cells[3 * i + 2])].push_back(i);
+                isSelected[i] = 1;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < numCandidates; ++i) {
+        if (isSelected[i]) {
+            selected.push_back(i);
+        }
+    }
+    return selected;
+}
+
+/**
+ * Removes points from a Poisson-disk set until a given number remain, taking them where the set is densest.
+ * This is weighted sample elimination: every point is weighted by its neighbours closer than twice the radius,
+ * nearer ones counting more, and the heaviest point is removed and its neighbours reweighted until the count
+ * is reached. The removals spread over the surface instead of opening holes.
+ * @param candidates Flat vector of xyz candidate coordinates.
+ * @param selected Indices of the selected candidates, as returned by selectPoissonDisk.
+ * @param radius Radius the set was selected with.
+ * @param count Number of points to keep.
+ * @return Indices of the kept candidates in increasing order.
+ */
+std::vector<size_t> thinPoissonDisk(const std::vector<float>& candidates, const std::vector<size_t>& selected, float radius,
+    size_t count) {
+    if (selected.size() <= count) {
+        return selected;
+    }
+    float minCorner[3], maxCorner[3];
+    for (int k = 0; k < 3; ++k) {
+        minCorner[k] = maxCorner[k] = candidates[3 * selected[0] + k];
+    }
+    for (size_t p = 1; p < selected.size(); ++p) {
+        for (int k = 0; k < 3; ++k) {
+            minCorner[k] = std::min(minCorner[k], candidates[3 * selected[p] + k]);
+            maxCorner[k] = std::max(maxCorner[k], candidates[3 * selected[p] + k]);
+        }
+    }
+
+    // Cells as wide as the neighbourhood, so neighbours are within the 27 cells around
+    float reach = 2.0f * radius;
+    float cellSize = reach;
+    for (int k = 0; k < 3; ++k) {
+        cellSize = std::max(cellSize, (maxCorner[k] - minCorner[k]) / ((1 << 21) - 2));
+    }
+    if (!(cellSize > 0.0f)) {
+        cellSize = 1.0f;
+    }
+    std::vector<int> cells(3 * selected.size());
+    CellHash hash;
+    for (size_t p = 0; p < selected.size(); ++p) {
+        for (int k = 0; k < 3; ++k) {
+            cells[3 * p + k] = static_cast<int>((candidates[3 * selected[p] + k] - minCorner[k]) / cellSize);
+        }
+        hash[cellKey(cells[3 * p], cells[3 * p + 1], cells[3 * p + 2])].push_back(p);
+    }
+
+    // Neighbours and their weights (1 - d / reach)^8, grouped by point
+    std::vector<std::vector<std::pair<size_t, float> > > neighbours(selected.size());
+    std::vector<float> weights(selected.size(), 0.0f);
+    parallelFor(selected.size(), [&](size_t p) {
+        const float* point = &candidates[3 * selected[p]];
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    CellHash::const_iterator found = hash.find(cellKey(cells[3 * p] + dx, cells[3 * p + 1] + dy, cells[3 * p + 2] + dz));
+                    for (size_t i = 0; found != hash.end() && i < found->second.size(); ++i) {
+                        size_t q = found->second[i];
+                        const float* other = &candidates[3 * selected[q]];
+                        float d[3] = { point[0] - other[0], point[1] - other[1], point[2] - other[2] };
+                        float distance = std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+                        if (q != p && distance < reach) {
+                            float w = 1.0f - distance / reach;
+                            w *= w;
+                            w *= w;
+                            w *= w;
+                            neighbours[p].push_back(std::make_pair(q, w));
+                            weights[p] += w;
+                        }
+                    }
+                }
+            }
+        }
+    });
+
+    // Heaviest point first; entries whose weight changed since they were pushed are skipped
+    std::priority_queue<std::pair<float, size_t> > heap;
+    for (size_t p = 0; p < selected.size(); ++p) {
+        heap.push(std::make_pair(weights[p], p));
+    }
+    std::vector<char> removed(selected.size(), 0);
+    size_t remaining = selected.size();
+    while (remaining > count && !heap.empty()) {
+        std::pair<float, size_t> top = heap.top();
+        heap.pop();
+        size_t p = top.second;
+        if (removed[p] || top.first != weights[p]) {
+            continue;
+        }
+        removed[p] = 1;
+        --remaining;
+        for (size_t i = 0; i < neighbours[p].size(); ++i) {
+            size_t q = neighbours[p][i].first;
+            if (!removed[q]) {
+                weights[q] -= neighbours[p][i].second;
+                heap.push(std::make_pair(weights[q], q));
+            }
+        }
+    }
+
+    std::vector<size_t> kept;
+    for (size_t p = 0; p < selected.size(); ++p) {
+        if (!removed[p]) {
+            kept.push_back(selected[p]);
+        }
+    }
+    return kept;
+}
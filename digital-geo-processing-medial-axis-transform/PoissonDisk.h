@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Selects a Poisson-disk subset of candidate points: no two selected points are closer than the radius.
+ * Candidates are hashed into cells as wide as the radius and grouped into patches of cells. Patches are
+ * processed in 8 rounds by the parity of their coordinates; within a round no two patches are adjacent,
+ * so they run in parallel, and each accepts its candidates in input order against the points already
+ * accepted around it. The result only depends on the input, not on the number of threads.
+ * @param candidates Flat vector of xyz candidate coordinates, in random order for an unbiased selection.
+ * @param radius Minimum distance between selected points.
+ * @return Indices of the selected candidates in increasing order.
+ */
+std::vector<size_t> selectPoissonDisk(const std::vector<float>& candidates, float radius);
+
+/**
+ * Removes points from a Poisson-disk set until a given number remain, taking them where the set is densest.
+ * This is weighted sample elimination: every point is weighted by its neighbours closer than twice the radius,
+ * nearer ones counting more, and the heaviest point is removed and its neighbours reweighted until the count
+ * is reached. The removals spread over the surface instead of opening holes.
+ * @param candidates Flat vector of xyz candidate coordinates.
+ * @param selected Indices of the selected candidates, as returned by selectPoissonDisk.
+ * @param radius Radius the set was selected with.
+ * @param count Number of points to keep.
+ * @return Indices of the kept candidates in increasing order.
+ */
+std::vector<size_t> thinPoissonDisk(const std::vector<float>& candidates, const std::vector<size_t>& selected, float radius,
+    size_t count);
@@ -0,0 +1,62 @@
+#include "Polygon2D.h"
+#include <cmath>
+#include <cstdio>
+
+/**
+ * Loads rings from a text file. The file starts with the number of rings; every ring is its vertex count
+ * followed by that many "x y" lines. Each ring is closed back to its first vertex.
+ * @param name Path of the file.
+ * @return True on success.
+ */
+bool Polygon2D::loadPolygon(const char* name) {
+    FILE* file = std::fopen(name, "r");
+    if (file == nullptr) {
+        return false;
+    }
+    int numRings = 0;
+    bool ok = std::fscanf(file, "%d", &numRings) == 1;
+    for (int r = 0; ok && r < numRings; ++r) {
+        int numPoints = 0;
+        ok = std::fscanf(file, "%d", &numPoints) == 1 && numPoints >= 3;
+        std::vector<float> ring(2 * static_cast<size_t>(ok ? numPoints : 0));
+        for (size_t i = 0; ok && i < ring.size(); i += 2) {
+            ok = std::fscanf(file, "%f %f", &ring[i], &ring[i + 1]) == 2;
+        }
+        if (ok) {
+            addRing(ring);
+        }
+    }
+    std::fclose(file);
+    return ok;
+}
+
+/**
+ * Appends a closed ring.
+ * @param ringCoords Flat xy coordinates of the ring vertices in order.
+ */
+void Polygon2D::addRing(const std::vector<float>& ringCoords) {
+    int first = static_cast<int>(coords.size() / 2);
+    int numPoints = static_cast<int>(ringCoords.size() / 2);
+    coords.insert(coords.end(), ringCoords.begin(), ringCoords.begin() + 2 * numPoints);
+    for (int i = 0; i < numPoints; ++i) {
+        segments.push_back(first + i);
+        segments.push_back(first + (i + 1) % numPoints);
+    }
+}
+
+/**
+ * Appends a regular polygon approximating a circle.
+ * @param cx X coordinate of the center.
+ * @param cy Y coordinate of the center.
+ * @param radius Radius of the circle.
+ * @param numSegments Number of segments.
+ */
+void Polygon2D::addCircle(float cx, float cy, float radius, int numSegments) {
+    std::vector<float> ring(2 * static_cast<size_t>(numSegments));
+    for (int i = 0; i < numSegments; ++i) {
+        float angle = 2.0f * 3.14159265f * i / numSegments;
+        ring[2 * i] = cx + radius * std::cos(angle);
+        ring[2 * i + 1] = cy + radius * std::sin(angle);
+    }
+    addRing(ring);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Planar region bounded by closed rings, the 2D counterpart of Mesh.
+ * Named Polygon2D because windows.h already declares a Polygon function.
+ * The boundary is stored as a segment soup over a shared vertex array.
+ */
+class Polygon2D {
+public:
+    std::vector<float> coords; ///< Flat xy vertex coordinates.
+    std::vector<int> segments; ///< Vertex indices, 2 per boundary segment.
+
+    /**
+     * Loads rings from a text file. The file starts with the number of rings; every ring is its vertex count
+     * followed by that many "x y" lines. Each ring is closed back to its first vertex.
+     * @param name Path of the file.
+     * @return True on success.
+     */
+    bool loadPolygon(const char* name);
+
+    /**
+     * Appends a closed ring.
+     * @param ringCoords Flat xy coordinates of the ring vertices in order.
+     */
+    void addRing(const std::vector<float>& ringCoords);
+
+    /**
+     * Appends a regular polygon approximating a circle.
+     * @param cx X coordinate of the center.
+     * @param cy Y coordinate of the center.
+     * @param radius Radius of the circle.
+     * @param numSegments Number of segments.
+     */
+    void addCircle(float cx, float cy, float radius, int numSegments);
+};
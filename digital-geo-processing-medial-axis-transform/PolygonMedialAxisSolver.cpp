@@ -0,0 +1,242 @@
+#include "PolygonMedialAxisSolver.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+/**
+ * Builds the bands.
+ * @param segments Flat vector of segment end points, 4 floats per segment.
+ */
+void PolygonCrossingIndex::build(const std::vector<float>& segments) {
+    this->segments = segments;
+    int numSegments = static_cast<int>(segments.size() / 4);
+    bandStart.assign(1, 0);
+    bandItems.clear();
+    if (numSegments == 0) {
+        minY = 0.0f;
+        bandHeight = 1.0f;
+        return;
+    }
+
+    float maxY = segments[1];
+    minY = segments[1];
+    for (int s = 0; s < numSegments; ++s) {
+        minY = std::min(minY, std::min(segments[4 * s + 1], segments[4 * s + 3]));
+        maxY = std::max(maxY, std::max(segments[4 * s + 1], segments[4 * s + 3]));
+    }
+    // About one band per segment keeps every band short for outlines of any size
+    int numBands = std::max(1, std::min(numSegments, 1 << 16));
+    bandHeight = std::max((maxY - minY) / numBands, 1e-30f);
+    bandStart.assign(numBands + 1, 0);
+
+    for (int pass = 0; pass < 2; ++pass) {
+        std::vector<int> fill;
+        if (pass == 1) {
+            for (int b = 0; b < numBands; ++b) {
+                bandStart[b + 1] += bandStart[b];
+            }
+            bandItems.resize(bandStart[numBands]);
+            fill.assign(bandStart.begin(), bandStart.end() - 1);
+        }
+        for (int s = 0; s < numSegments; ++s) {
+            float y0 = std::min(segments[4 * s + 1], segments[4 * s + 3]);
+            float y1 = std::max(segments[4 * s + 1], segments[4 * s + 3]);
+            int first = std::min(numBands - 1, static_cast<int>((y0 - minY) / bandHeight));
+            int last = std::min(numBands - 1, static_cast<int>((y1 - minY) / bandHeight));
+            for (int b = first; b <= last; ++b) {
+                if (pass == 0) {
+                    ++bandStart[b + 1];
+                } else {
+                    bandItems[fill[b]++] = s;
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Counts the segments crossed by the ray from a point towards +x.
+ * Segments are half-open in y, so a ray through a shared vertex counts it once.
+ * @param point Coordinates of the point.
+ * @return The number of crossings.
+ */
+int PolygonCrossingIndex::countCrossings(const float* point) const {
+    int numBands = static_cast<int>(bandStart.size()) - 1;
+    float offset = (point[1] - minY) / bandHeight;
+    if (numBands <= 0 || offset < 0.0f || offset > numBands) {
+        return 0;
+    }
+    int band = std::min(numBands - 1, static_cast<int>(offset));
+    int crossings = 0;
+    for (int i = bandStart[band]; i < bandStart[band + 1]; ++i) {
+        const float* s = &segments[4 * bandItems[i]];
+        if ((s[1] <= point[1]) != (s[3] <= point[1])) {
+            float x = s[0] + (point[1] - s[1]) * (s[2] - s[0]) / (s[3] - s[1]);
+            if (x > point[0]) {
+                crossings++;
+            }
+        }
+    }
+    return crossings;
+}
+
+/**
+ * Constructor for PolygonMedialAxisSolver.
+ */
+PolygonMedialAxisSolver::PolygonMedialAxisSolver() : diagonal(0.0f), tolerance(0.0f), inwardOffset(0.0f) {
+}
+
+/**
+ * Sets the boundary and builds the derived state: the length table for sampling, the outward normals
+ * and the acceleration structure of the inside test.
+ * @param points Flat vector of boundary vertex coordinates, 2 per vertex.
+ * @param segments Flat vector of vertex indices, 2 per boundary segment.
+ */
+void PolygonMedialAxisSolver::build(const std::vector<float>& points, const std::vector<int>& segments) {
+    this->points = points;
+    this->segments = segments;
+    size_t numSegments = segments.size() / 2;
+    lengthSums.resize(numSegments);
+    segmentNormals.resize(2 * numSegments);
+    std::vector<float> soup(4 * numSegments);
+
+    double total = 0.0, signedArea = 0.0;
+    for (size_t s = 0; s < numSegments; ++s) {
+        const float* a = &points[2 * static_cast<size_t>(segments[2 * s])];
+        const float* b = &points[2 * static_cast<size_t>(segments[2 * s + 1])];
+        std::copy(a, a + 2, &soup[4 * s]);
+        std::copy(b, b + 2, &soup[4 * s + 2]);
+
+        float dx = b[0] - a[0], dy = b[1] - a[1];
+        float length = std::hypot(dx, dy);
+        total += length;
+        lengthSums[s] = total;
+        // Shoelace term of the triangle spanned by the origin and the segment
+        signedArea += 0.5 * (static_cast<double>(a[0]) * b[1] - static_cast<double>(a[1]) * b[0]);
+        // Right of the segment direction, which points out of counterclockwise rings
+        segmentNormals[2 * s] = length > 0.0f ? dy / length : 0.0f;
+        segmentNormals[2 * s + 1] = length > 0.0f ? -dx / length : 0.0f;
+    }
+
+    // Normals point inward if the boundary is wound clockwise
+    if (signedArea < 0.0) {
+        for (size_t i = 0; i < segmentNormals.size(); ++i) {
+            segmentNormals[i] = -segmentNormals[i];
+        }
+    }
+
+    double squared = 0.0;
+    for (int k = 0; k < 2 && !points.empty(); ++k) {
+        float lo = points[k], hi = points[k];
+        for (size_t i = k; i < points.size(); i += 2) {
+            lo = std::min(lo, points[i]);
+            hi = std::max(hi, points[i]);
+        }
+        squared += static_cast<double>(hi - lo) * (hi - lo);
+    }
+    diagonal = static_cast<float>(std::sqrt(squared));
+
+    index.build(soup);
+}
+
+/**
+ * Sets the convergence threshold of the binary search.
+ * @param tolerance Length of the final search interval, or 0 for 1e-4 of the bounding box diagonal.
+ */
+void PolygonMedialAxisSolver::setTolerance(float tolerance) {
+    this->tolerance = tolerance;
+}
+
+/**
+ * Sets how far the samples are moved inward to start the search.
+ * @param offset The inward offset, or 0 for 1e-3 of the bounding box diagonal.
+ */
+void PolygonMedialAxisSolver::setInwardOffset(float offset) {
+    inwardOffset = offset;
+}
+
+/**
+ * Samples points on the boundary, with probability proportional to the length of each segment.
+ * @param count Number of samples.
+ * @param seed Seed of the random numbers.
+ * @param samples Flat vector to fill with sample coordinates.
+ * @param normals Flat vector to fill with the outward unit normals of the samples.
+ */
+void PolygonMedialAxisSolver::samplePoints(int count, unsigned int seed, std::vector<float>& samples, std::vector<float>& normals) const {
+    samples.clear();
+    normals.clear();
+    if (lengthSums.empty() || lengthSums.back() <= 0.0) {
+        return;
+    }
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    samples.resize(2 * static_cast<size_t>(count));
+    normals.resize(2 * static_cast<size_t>(count));
+    for (int i = 0; i < count; ++i) {
+        double r = uniform(generator) * lengthSums.back();
+        size_t s = std::upper_bound(lengthSums.begin(), lengthSums.end(), r) - lengthSums.begin();
+        s = std::min(s, lengthSums.size() - 1);
+
+        const float* a = &points[2 * static_cast<size_t>(segments[2 * s])];
+        const float* b = &points[2 * static_cast<size_t>(segments[2 * s + 1])];
+        float u = static_cast<float>(uniform(generator));
+        float* sample = &samples[2 * static_cast<size_t>(i)];
+        sample[0] = a[0] + u * (b[0] - a[0]);
+        sample[1] = a[1] + u * (b[1] - a[1]);
+        std::copy(&segmentNormals[2 * s], &segmentNormals[2 * s] + 2, &normals[2 * static_cast<size_t>(i)]);
+    }
+}
+
+/**
+ * Checks if a point is inside the boundary using ray casting.
+ * @param point Coordinates of the point.
+ * @return True if the point is inside, false otherwise.
+ */
+bool PolygonMedialAxisSolver::isPointInside(const float* point) const {
+    return (index.countCrossings(point) % 2) == 1; // Point is inside if intersections count is odd
+}
+
+/**
+ * Computes one maximal ball per sample.
+ * The search runs from just inside the sample to a bounding box diagonal further along the inward normal;
+ * the inner end of the final bracket is the opposite wall. Samples whose start point is not inside
+ * (thin features narrower than the offset) produce no ball.
+ * @param samples Flat vector of sample coordinates.
+ * @param normals Flat vector of the outward unit normals of the samples.
+ * @param centers Flat vector to fill with ball centers.
+ * @param radii Vector to fill with ball radii.
+ */
+void PolygonMedialAxisSolver::computeMaximalBalls(const std::vector<float>& samples, const std::vector<float>& normals,
+    std::vector<float>& centers, std::vector<float>& radii) const {
+    float offset = inwardOffset > 0.0f ? inwardOffset : 1e-3f * diagonal;
+    float threshold = tolerance > 0.0f ? tolerance : 1e-4f * diagonal;
+    size_t numSamples = samples.size() / 2;
+    for (size_t i = 0; i < numSamples; ++i) {
+        const float* sample = &samples[2 * i];
+        const float* normal = &normals[2 * i];
+        float inside[2], outside[2], mid[2];
+        for (int k = 0; k < 2; ++k) {
+            inside[k] = sample[k] - offset * normal[k];
+            outside[k] = inside[k] - diagonal * normal[k];
+        }
+        if (!isPointInside(inside)) {
+            continue;
+        }
+
+        float length = diagonal;
+        while (length >= threshold) {
+            for (int k = 0; k < 2; ++k) {
+                mid[k] = 0.5f * (inside[k] + outside[k]);
+            }
+            std::copy(mid, mid + 2, isPointInside(mid) ? inside : outside);
+            length *= 0.5f;
+        }
+
+        float chord = 0.0f;
+        for (int k = 0; k < 2; ++k) {
+            centers.push_back(0.5f * (sample[k] + inside[k]));
+            chord += (inside[k] - sample[k]) * (inside[k] - sample[k]);
+        }
+        radii.push_back(0.5f * std::sqrt(chord));
+    }
+}
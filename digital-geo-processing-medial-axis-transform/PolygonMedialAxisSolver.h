@@ -0,0 +1,102 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Inside test for polygons: the boundary segments are bucketed into horizontal bands,
+ * and a ray towards +x only tests the segments of the band holding its origin.
+ */
+class PolygonCrossingIndex {
+public:
+    /**
+     * Builds the bands.
+     * @param segments Flat vector of segment end points, 4 floats per segment.
+     */
+    void build(const std::vector<float>& segments);
+
+    /**
+     * Counts the segments crossed by the ray from a point towards +x.
+     * Segments are half-open in y, so a ray through a shared vertex counts it once.
+     * @param point Coordinates of the point.
+     * @return The number of crossings.
+     */
+    int countCrossings(const float* point) const;
+
+private:
+    std::vector<float> segments; ///< Segment end points, 4 floats per segment.
+    float minY; ///< Bottom of the lowest band.
+    float bandHeight; ///< Height of a band.
+    std::vector<int> bandStart; ///< Segments of band b are bandItems[bandStart[b], bandStart[b + 1]).
+    std::vector<int> bandItems; ///< Segment indices grouped by band.
+};
+
+/**
+ * Medial axis pipeline for polygons: boundary sampling, inside test and maximal ball search.
+ * Points are flat float arrays with 2 values each; a boundary segment has 2 corners.
+ * Triangle meshes go through MedialAxisTransformer instead.
+ *
+ * Each sample is pushed inward along its normal and the chord to the opposite wall is found by binary search;
+ * the ball sits at the middle of the chord and touches both walls.
+ */
+class PolygonMedialAxisSolver {
+public:
+    /**
+     * Constructor for PolygonMedialAxisSolver.
+     */
+    PolygonMedialAxisSolver();
+
+    /**
+     * Sets the boundary and builds the derived state.
+     * @param points Flat vector of boundary vertex coordinates, 2 per vertex.
+     * @param segments Flat vector of vertex indices, 2 per boundary segment.
+     */
+    void build(const std::vector<float>& points, const std::vector<int>& segments);
+
+    /**
+     * Sets the convergence threshold of the binary search.
+     * @param tolerance Length of the final search interval, or 0 for 1e-4 of the bounding box diagonal.
+     */
+    void setTolerance(float tolerance);
+
+    /**
+     * Sets how far the samples are moved inward to start the search.
+     * @param offset The inward offset, or 0 for 1e-3 of the bounding box diagonal.
+     */
+    void setInwardOffset(float offset);
+
+    /**
+     * Samples points on the boundary, with probability proportional to the length of each segment.
+     * @param count Number of samples.
+     * @param seed Seed of the random numbers.
+     * @param samples Flat vector to fill with sample coordinates.
+     * @param normals Flat vector to fill with the outward unit normals of the samples.
+     */
+    void samplePoints(int count, unsigned int seed, std::vector<float>& samples, std::vector<float>& normals) const;
+
+    /**
+     * Checks if a point is inside the boundary using ray casting.
+     * @param point Coordinates of the point.
+     * @return True if the point is inside, false otherwise.
+     */
+    bool isPointInside(const float* point) const;
+
+    /**
+     * Computes one maximal ball per sample.
+     * @param samples Flat vector of sample coordinates.
+     * @param normals Flat vector of the outward unit normals of the samples.
+     * @param centers Flat vector to fill with ball centers.
+     * @param radii Vector to fill with ball radii.
+     */
+    void computeMaximalBalls(const std::vector<float>& samples, const std::vector<float>& normals,
+        std::vector<float>& centers, std::vector<float>& radii) const;
+
+private:
+    std::vector<float> points; ///< Boundary vertex coordinates.
+    std::vector<int> segments; ///< Boundary segments.
+    std::vector<double> lengthSums; ///< Running sum of the segment lengths.
+    std::vector<float> segmentNormals; ///< Outward unit normal of each segment.
+    PolygonCrossingIndex index; ///< Acceleration structure of the inside test.
+    float diagonal; ///< Length of the bounding box diagonal.
+    float tolerance; ///< Convergence threshold, or 0 for the default.
+    float inwardOffset; ///< Start offset, or 0 for the default.
+};
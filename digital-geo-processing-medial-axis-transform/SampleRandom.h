@@ -0,0 +1,19 @@
+#pragma once
+
+/**
+ * Returns a uniform random number in [0, 1) that only depends on a seed, a sample index and a stream,
+ * so a sample is drawn the same way no matter how many samples are requested or in which order.
+ * @param seed The seed.
+ * @param sample Index of the sample.
+ * @param stream Which of the numbers of the sample to return, from 0 to 3.
+ * @return The random number.
+ */
+inline float sampleRandom(unsigned int seed, int sample, int stream) {
+    // SplitMix64 finalizer over the packed inputs
+    unsigned long long x = (static_cast<unsigned long long>(seed) << 32) ^ (static_cast<unsigned long long>(static_cast<unsigned int>(sample)) << 2) ^ stream;
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<float>(x >> 40) / 16777216.0f;
+}
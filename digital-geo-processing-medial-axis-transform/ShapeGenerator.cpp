@@ -0,0 +1,374 @@
+#include "ShapeGenerator.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+static const float PI = 3.14159265f;
+
+/**
+ * Largest number of triangles requested from generateShape: a closed triangulation has about half as many
+ * vertices as triangles, and vertex indices are int, so about 2.1 * 10^9 vertices.
+ */
+static const long long MAX_TRIANGLES = 2LL * INT_MAX - 8;
+
+/**
+ * Returns a shape of the given type with default proportions: unit sphere, torus with radii 2 and 0.5,
+ * capsule with radius 0.5 and axis length 2, all without noise.
+ * @param type Kind of shape.
+ * @param numTris Requested number of triangles.
+ * @return The shape parameters.
+ */
+ShapeSpec defaultShape(ShapeType type, long long numTris) {
+    ShapeSpec spec = { type, 1.0f, 0.0f, 0.0f, numTris, 1 };
+    if (type == ShapeType::TORUS) {
+        spec.radius = 0.5f;
+        spec.size = 2.0f;
+    }
+    else if (type == ShapeType::CAPSULE) {
+        spec.radius = 0.5f;
+        spec.size = 1.0f;
+    }
+    return spec;
+}
+
+/**
+ * Revolves a profile curve around the z axis.
+ * An open profile must start and end on the axis; those two points become single pole vertices.
+ * A closed profile must stay off the axis and is joined back to its first point.
+ * The profile runs upwards on the side facing away from the axis so that triangles face outwards.
+ * @param profile Flat vector of (distance to axis, z) pairs.
+ * @param closed True if the profile is a closed loop.
+ * @param segments Number of vertices around each ring.
+ * @param coords Flat vector to fill with xyz vertex coordinates.
+ * @param triangles Flat vector to fill with vertex indices, 3 per triangle.
+ */
+static void revolve(const std::vector<float>& profile, bool closed, int segments, std::vector<float>& coords,
+    std::vector<int>& triangles) {
+    int numPoints = static_cast<int>(profile.size() / 2);
+    int firstRing = closed ? 0 : 1;
+    int numRings = closed ? numPoints : numPoints - 2;
+    int numBands = closed ? numRings : numRings - 1;
+
+    coords.clear();
+    triangles.clear();
+    coords.reserve(3 * (static_cast<size_t>(numRings) * segments + (closed ? 0 : 2)));
+    triangles.reserve(6 * static_cast<size_t>(segments) * (closed ? numBands : numBands + 1));
+
+    std::vector<float> cosines(segments), sines(segments);
+    for (int j = 0; j < segments; ++j) {
+        float angle = 2.0f * PI * j / segments;
+        cosines[j] = std::cos(angle);
+        sines[j] = std::sin(angle);
+    }
+
+    if (!closed) {
+        coords.push_back(0.0f);
+        coords.push_back(0.0f);
+        coords.push_back(profile[1]);
+    }
+    for (int i = 0; i < numRings; ++i) {
+        float rho = profile[2 * (firstRing + i)];
+        float z = profile[2 * (firstRing + i) + 1];
+        for (int j = 0; j < segments; ++j) {
+            coords.push_back(rho * cosines[j]);
+            coords.push_back(rho * sines[j]);
+            coords.push_back(z);
+        }
+    }
+    if (!closed) {
+        coords.push_back(0.0f);
+        coords.push_back(0.0f);
+        coords.push_back(profile.back());
+    }
+
+    // Index of vertex j of ring i
+    int ringBase = closed ? 0 : 1;
+    int north = ringBase + numRings * segments;
+    for (int j = 0; j < segments; ++j) {
+        int next = (j + 1) % segments;
+        for (int i = 0; i < numBands; ++i) {
+            int lower = ringBase + i * segments;
+            int upper = ringBase + ((i + 1) % numRings) * segments;
+            int quad[4] = { lower + j, lower + next, upper + next, upper + j };
+            triangles.insert(triangles.end(), quad, quad + 3);
+            triangles.push_back(quad[0]);
+            triangles.push_back(quad[2]);
+            triangles.push_back(quad[3]);
+        }
+        if (!closed) {
+            int top = ringBase + (numRings - 1) * segments;
+            int southFan[3] = { 0, ringBase + next, ringBase + j };
+            int northFan[3] = { top + j, top + next, north };
+            triangles.insert(triangles.end(), southFan, southFan + 3);
+            triangles.insert(triangles.end(), northFan, northFan + 3);
+        }
+    }
+}
+
+/**
+ * Builds the profile of a capsule, or of a sphere when the half-length is 0: a half circle from the south pole
+ * to the north pole, split at the equator by a straight segment of twice the half-length.
+ * @param radius Radius of the caps and the cylinder.
+ * @param halfLength Half-length of the axis segment.
+ * @param numTris Requested number of triangles.
+ * @param segments Receives the number of vertices around each ring.
+ * @return Flat vector of (distance to axis, z) pairs.
+ */
+static std::vector<float> capsuleProfile(float radius, float halfLength, long long numTris, int& segments) {
+    // Edge length that gives the requested count when rings and segments are spaced alike
+    double profileLength = PI * radius + 2.0 * halfLength;
+    double spacing = std::sqrt(4.0 * PI * radius * profileLength / std::max(1LL, numTris));
+    int capSteps = std::max(1, static_cast<int>(std::round(0.5 * PI * radius / spacing)));
+    int cylinderSteps = halfLength > 0.0f ? std::max(1, static_cast<int>(std::round(2.0 * halfLength / spacing))) : 0;
+    // Every ring adds 2 triangles per segment, so the segments absorb the rounding of the ring count
+    int numRings = 2 * capSteps + cylinderSteps - 1;
+    segments = std::max(3, static_cast<int>(std::round(numTris / (2.0 * numRings))));
+
+    std::vector<float> profile;
+    for (int i = 0; i <= capSteps; ++i) {
+        float angle = -0.5f * PI + 0.5f * PI * i / capSteps;
+        profile.push_back(i == 0 ? 0.0f : radius * std::cos(angle));
+        profile.push_back(-halfLength + radius * std::sin(angle));
+    }
+    for (int i = 1; i <= cylinderSteps; ++i) {
+        profile.push_back(radius);
+        profile.push_back(-halfLength + 2.0f * halfLength * i / cylinderSteps);
+    }
+    for (int i = 1; i <= capSteps; ++i) {
+        float angle = 0.5f * PI * i / capSteps;
+        profile.push_back(i == capSteps ? 0.0f : radius * std::cos(angle));
+        profile.push_back(halfLength + radius * std::sin(angle));
+    }
+    return profile;
+}
+
+/**
+ * Builds the profile of a torus: the tube circle, starting on the outer equator and running upwards.
+ * @param majorRadius Distance from the axis to the tube center.
+ * @param minorRadius Radius of the tube.
+ * @param numTris Requested number of triangles.
+ * @param segments Receives the number of vertices around each ring.
+ * @return Flat vector of (distance to axis, z) pairs.
+ */
+static std::vector<float> torusProfile(float majorRadius, float minorRadius, long long numTris, int& segments) {
+    double spacing = std::sqrt(8.0 * PI * PI * majorRadius * minorRadius / std::max(1LL, numTris));
+    int steps = std::max(3, static_cast<int>(std::round(2.0 * PI * minorRadius / spacing)));
+    segments = std::max(3, static_cast<int>(std::round(numTris / (2.0 * steps))));
+
+    std::vector<float> profile;
+    for (int i = 0; i < steps; ++i) {
+        float angle = 2.0f * PI * i / steps;
+        profile.push_back(majorRadius + minorRadius * std::cos(angle));
+        profile.push_back(minorRadius * std::sin(angle));
+    }
+    return profile;
+}
+
+/**
+ * Finds the point of the exact medial axis of a shape without noise closest to a point.
+ * @param spec Shape parameters.
+ * @param point Coordinates of the point.
+ * @param foot Array of 3 floats to store the closest axis point.
+ */
+static void closestAxisPoint(const ShapeSpec& spec, const float* point, float* foot) {
+    foot[0] = foot[1] = foot[2] = 0.0f;
+    if (spec.type == ShapeType::TORUS) {
+        float rho = std::sqrt(point[0] * point[0] + point[1] * point[1]);
+        foot[0] = rho > 0.0f ? spec.size * point[0] / rho : spec.size;
+        foot[1] = rho > 0.0f ? spec.size * point[1] / rho : 0.0f;
+    }
+    else if (spec.type == ShapeType::CAPSULE) {
+        foot[2] = std::max(-spec.size, std::min(spec.size, point[2]));
+    }
+}
+
+/**
+ * Moves every vertex away from its closest medial axis point, scaling their distance by 1 + amplitude * noise,
+ * where the noise is a sum of random plane waves over the position in units of the shape radius.
+ * Each vertex stays on the ray from its axis point and the amplitude stays below 1, so the surface remains
+ * free of self-intersections.
+ * @param spec Shape parameters; noise is the amplitude and seed the seed of the waves.
+ * @param coords Flat vector of xyz vertex coordinates.
+ */
+static void displaceFromAxis(const ShapeSpec& spec, std::vector<float>& coords) {
+    const int NUM_WAVES = 8;
+    float waves[NUM_WAVES][5];
+    std::mt19937 generator(spec.seed);
+    std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+    for (int w = 0; w < NUM_WAVES; ++w) {
+        float axis[3], length;
+        do {
+            axis[0] = uniform(generator);
+            axis[1] = uniform(generator);
+            axis[2] = uniform(generator);
+            length = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+        } while (length < 0.1f || length > 1.0f);
+        for (int k = 0; k < 3; ++k) {
+            waves[w][k] = axis[k] / length;
+        }
+        waves[w][3] = 3.5f + 2.5f * uniform(generator); // Frequency
+        waves[w][4] = PI * uniform(generator); // Phase
+    }
+
+    float amplitude = std::min(std::fabs(spec.noise), 0.9f);
+    for (size_t v = 0; v < coords.size(); v += 3) {
+        float* p = &coords[v];
+        float noise = 0.0f;
+        for (int w = 0; w < NUM_WAVES; ++w) {
+            float along = (p[0] * waves[w][0] + p[1] * waves[w][1] + p[2] * waves[w][2]) / spec.radius;
+            noise += std::sin(waves[w][3] * along + waves[w][4]);
+        }
+        float scale = 1.0f + amplitude * noise / NUM_WAVES;
+        float foot[3];
+        closestAxisPoint(spec, p, foot);
+        for (int k = 0; k < 3; ++k) {
+            p[k] = foot[k] + scale * (p[k] - foot[k]);
+        }
+    }
+}
+
+/**
+ * Builds a watertight, outward-oriented triangulation of a shape as a surface of revolution around the z axis.
+ * Rings are evenly spaced along the profile, so spheres are UV spheres whose poles are closed by triangle fans.
+ * With noise, every vertex is then moved away from its nearest medial axis point.
+ * Vertex indices are int, so shapes needing more than about 2.1 * 10^9 vertices are left empty.
+ * @param spec Shape parameters.
+ * @param coords Flat vector to fill with xyz vertex coordinates.
+ * @param triangles Flat vector to fill with vertex indices, 3 per triangle.
+ */
+void generateShape(const ShapeSpec& spec, std::vector<float>& coords, std::vector<int>& triangles) {
+    coords.clear();
+    triangles.clear();
+    if (spec.numTris > MAX_TRIANGLES) {
+        return;
+    }
+    int segments = 0;
+    if (spec.type == ShapeType::TORUS) {
+        std::vector<float> profile = torusProfile(spec.size, spec.radius, spec.numTris, segments);
+        revolve(profile, true, segments, coords, triangles);
+    }
+    else {
+        float halfLength = spec.type == ShapeType::CAPSULE ? spec.size : 0.0f;
+        std::vector<float> profile = capsuleProfile(spec.radius, halfLength, spec.numTris, segments);
+        revolve(profile, false, segments, coords, triangles);
+    }
+    if (spec.noise != 0.0f) {
+        displaceFromAxis(spec, coords);
+    }
+}
+
+/**
+ * Checks a triangulation built by generateShape and prints every failed check to stderr.
+ * The triangulation must be watertight and consistently oriented, i.e. every directed edge appears once and its
+ * reverse once, enclose a positive volume, so that triangles face outwards, and have a triangle count within 5%
+ * of the requested one, or within 12 triangles for the smallest shapes.
+ * @param spec Shape parameters the triangulation was built from.
+ * @param coords Flat vector of xyz vertex coordinates.
+ * @param triangles Flat vector of vertex indices, 3 per triangle.
+ * @return True if every check passed.
+ */
+bool validateShape(const ShapeSpec& spec, const std::vector<float>& coords, const std::vector<int>& triangles) {
+    long long numVerts = static_cast<long long>(coords.size() / 3);
+    long long numTris = static_cast<long long>(triangles.size() / 3);
+    bool valid = true;
+    if (numTris == 0) {
+        std::fprintf(stderr, "Shape check failed: no triangles for %lld requested\n", spec.numTris);
+        return false;
+    }
+    for (size_t i = 0; i < triangles.size(); ++i) {
+        if (triangles[i] < 0 || triangles[i] >= numVerts) {
+            std::fprintf(stderr, "Shape check failed: vertex index %d out of range\n", triangles[i]);
+            return false;
+        }
+    }
+
+    std::vector<unsigned long long> edges(triangles.size());
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        for (int c = 0; c < 3; ++c) {
+            unsigned long long from = static_cast<unsigned int>(triangles[t + c]);
+            unsigned long long to = static_cast<unsigned int>(triangles[t + (c + 1) % 3]);
+            edges[t + c] = (from << 32) | to;
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    size_t unpaired = 0;
+    for (size_t e = 0; e < edges.size(); ++e) {
+        unsigned long long reverse = (edges[e] << 32) | (edges[e] >> 32);
+        bool repeated = e + 1 < edges.size() && edges[e + 1] == edges[e];
+        if (repeated || !std::binary_search(edges.begin(), edges.end(), reverse)) {
+            ++unpaired;
+        }
+    }
+    if (unpaired > 0) {
+        std::fprintf(stderr, "Shape check failed: %zu edges are open, non-manifold or inconsistently oriented\n", unpaired);
+        valid = false;
+    }
+
+    double volume = 0.0;
+    for (size_t t = 0; t < triangles.size(); t += 3) {
+        const float* a = &coords[3 * static_cast<size_t>(triangles[t])];
+        const float* b = &coords[3 * static_cast<size_t>(triangles[t + 1])];
+        const float* c = &coords[3 * static_cast<size_t>(triangles[t + 2])];
+        volume += (a[0] * (static_cast<double>(b[1]) * c[2] - static_cast<double>(b[2]) * c[1])
+            - a[1] * (static_cast<double>(b[0]) * c[2] - static_cast<double>(b[2]) * c[0])
+            + a[2] * (static_cast<double>(b[0]) * c[1] - static_cast<double>(b[1]) * c[0])) / 6.0;
+    }
+    if (!(volume > 0.0)) {
+        std::fprintf(stderr, "Shape check failed: enclosed volume %g is not positive, triangles face inwards\n", volume);
+        valid = false;
+    }
+
+    double tolerance = std::max(0.05 * spec.numTris, 12.0);
+    if (std::fabs(static_cast<double>(numTris - spec.numTris)) > tolerance) {
+        std::fprintf(stderr, "Shape check failed: %lld triangles for %lld requested\n", numTris, spec.numTris);
+        valid = false;
+    }
+    return valid;
+}
+
+/**
+ * Writes a triangulation to an OFF file.
+ * @param name Path of the OFF file.
+ * @param coords Flat vector of xyz vertex coordinates.
+ * @param triangles Flat vector of vertex indices, 3 per triangle.
+ * @return True on success.
+ */
+bool writeOff(const char* name, const std::vector<float>& coords, const std::vector<int>& triangles) {
+    FILE* file = std::fopen(name, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fprintf(file, "OFF\n%d %d 0\n", static_cast<int>(coords.size() / 3), static_cast<int>(triangles.size() / 3));
+    for (size_t i = 0; i < coords.size(); i += 3) {
+        std::fprintf(file, "%.9g %.9g %.9g\n", coords[i], coords[i + 1], coords[i + 2]);
+    }
+    for (size_t i = 0; i < triangles.size(); i += 3) {
+        std::fprintf(file, "3 %d %d %d\n", triangles[i], triangles[i + 1], triangles[i + 2]);
+    }
+    bool ok = !std::ferror(file);
+    return std::fclose(file) == 0 && ok;
+}
+
+/**
+ * Checks if the medial axis of a shape is known in closed form.
+ * @param spec Shape parameters.
+ * @return True for spheres, tori and capsules without noise.
+ */
+bool hasAnalyticMedialAxis(const ShapeSpec& spec) {
+    return spec.noise == 0.0f;
+}
+
+/**
+ * Computes the distance from a point to the exact medial axis of a shape.
+ * @param spec Shape parameters; the shape must have an analytic medial axis.
+ * @param point Coordinates of the point.
+ * @return The distance.
+ */
+float distanceToMedialAxis(const ShapeSpec& spec, const float* point) {
+    float foot[3];
+    closestAxisPoint(spec, point, foot);
+    float d[3] = { point[0] - foot[0], point[1] - foot[1], point[2] - foot[2] };
+    return std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+/**
+ * Kinds of synthetic shapes.
+ */
+enum class ShapeType {
+    SPHERE, ///< Sphere centered at the origin; the medial axis is the center.
+    TORUS, ///< Torus around the z axis; the medial axis is the circle of the major radius.
+    CAPSULE ///< Cylinder along the z axis capped by hemispheres; the medial axis is the axis segment.
+};
+
+/**
+ * Parameters of a synthetic shape.
+ */
+struct ShapeSpec {
+    ShapeType type; ///< Kind of shape.
+    float radius; ///< Sphere radius, tube radius of the torus and capsule.
+    float size; ///< Major radius of the torus, half-length of the capsule axis.
+    float noise; ///< Relative amplitude of a smooth random displacement away from the medial axis, 0 for none.
+    long long numTris; ///< Requested number of triangles; the result is within 5%. Vertex indices are int, so at most about 4.3 * 10^9.
+    unsigned int seed; ///< Seed of the displacement.
+};
+
+/**
+ * Returns a shape of the given type with default proportions: unit sphere, torus with radii 2 and 0.5,
+ * capsule with radius 0.5 and axis length 2, all without noise.
+ * @param type Kind of shape.
+ * @param numTris Requested number of triangles.
+ * @return The shape parameters.
+ */
+ShapeSpec defaultShape(ShapeType type, long long numTris);
+
+/**
+ * Builds a watertight, outward-oriented triangulation of a shape as a surface of revolution around the z axis.
+ * Rings are evenly spaced along the profile, so spheres are UV spheres whose poles are closed by triangle fans.
+ * With noise, every vertex is then moved away from its nearest medial axis point.
+ * Vertex indices are int, so shapes needing more than about 2.1 * 10^9 vertices are left empty.
+ * @param spec Shape parameters.
+ * @param coords Flat vector to fill with xyz vertex coordinates.
+ * @param triangles Flat vector to fill with vertex indices, 3 per triangle.
+ */
+void generateShape(const ShapeSpec& spec, std::vector<float>& coords, std::vector<int>& triangles);
+
+/**
+ * Checks a triangulation built by generateShape and prints every failed check to stderr.
+ * The triangulation must be watertight and consistently oriented, i.e. every directed edge appears once and its
+ * reverse once, enclose a positive volume, so that triangles face outwards, and have a triangle count within 5%
+ * of the requested one, or within 12 triangles for the smallest shapes.
+ * @param spec Shape parameters the triangulation was built from.
+ * @param coords Flat vector of xyz vertex coordinates.
+ * @param triangles Flat vector of vertex indices, 3 per triangle.
+ * @return True if every check passed.
+ */
+bool validateShape(const ShapeSpec& spec, const std::vector<float>& coords, const std::vector<int>& triangles);
+
+/**
+ * Writes a triangulation to an OFF file.
+ * @param name Path of the OFF file.
+ * @param coords Flat vector of xyz vertex coordinates.
+ * @param triangles Flat vector of vertex indices, 3 per triangle.
+ * @return True on success.
+ */
+bool writeOff(const char* name, const std::vector<float>& coords, const std::vector<int>& triangles);
+
+/**
+ * Checks if the medial axis of a shape is known in closed form.
+ * @param spec Shape parameters.
+ * @return True for spheres, tori and capsules without noise.
+ */
+bool hasAnalyticMedialAxis(const ShapeSpec& spec);
+
+/**
+ * Computes the distance from a point to the exact medial axis of a shape.
+ * @param spec Shape parameters; the shape must have an analytic medial axis.
+ * @param point Coordinates of the point.
+ * @return The distance.
+ */
+float distanceToMedialAxis(const ShapeSpec& spec, const float* point);